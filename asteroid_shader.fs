@@ -0,0 +1,28 @@
+#version 330 core
+
+in vec3 FragPos;
+in float Shade;
+
+out vec4 FragColor;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+};
+
+void main()
+{
+    // rocks are meant to look faceted: the face normal comes from the position's screen-space derivatives
+    vec3 norm = normalize(cross(dFdx(FragPos), dFdy(FragPos)));
+    if (dot(norm, viewPos.xyz - FragPos) < 0.0)
+        norm = -norm;
+
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+
+    vec3 rockColor = vec3(0.55, 0.5, 0.45) * Shade;
+    FragColor = vec4((0.15 + diff) * rockColor, 1.0);
+}
@@ -0,0 +1,65 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+// semi-major axis, mean motion, mean anomaly at time 0, spin rate
+layout (location = 1) in vec4 aOrbit;
+// raw shorts: eccentricity * 32767, then inclination, ascending node and argument of periapsis as fractions of pi * 32767
+layout (location = 2) in vec4 aElements;
+// spin axis x and z remapped to [0, 1], radius as a fraction of maxRadius, brightness
+layout (location = 3) in vec4 aLook;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+};
+
+// the sun relative to the camera
+uniform vec3 center;
+// wrapped to the period every rate is a whole number of turns in
+uniform float time;
+uniform float maxRadius;
+
+out vec3 FragPos;
+out float Shade;
+
+const float PI = 3.14159265;
+const float TWO_PI = 6.2831853;
+
+void main()
+{
+    float e = aElements.x / 32767.0;
+    vec3 angles = aElements.yzw * (PI / 32767.0);
+
+    // angle reduced to one turn before the trig, which loses precision on large arguments
+    float M = aOrbit.z + TWO_PI * fract(aOrbit.y * time / TWO_PI);
+    // belt eccentricities stay under 0.3: three Newton steps from E = M + e sin M are plenty
+    float E = M + e * sin(M);
+    for (int i = 0; i < 3; i++)
+        E -= (E - e * sin(E) - M) / (1.0 - e * cos(E));
+
+    // same perifocal axes as KeplerOrbit::axes, with the reference pole along +Y
+    float cosI = cos(angles.x), sinI = sin(angles.x);
+    float cosNode = cos(angles.y), sinNode = sin(angles.y);
+    float cosPeri = cos(angles.z), sinPeri = sin(angles.z);
+    vec3 toPeriapsis = vec3(cosNode * cosPeri - sinNode * sinPeri * cosI, sinPeri * sinI,
+        sinNode * cosPeri + cosNode * sinPeri * cosI);
+    vec3 ahead = vec3(-cosNode * sinPeri - sinNode * cosPeri * cosI, cosPeri * sinI,
+        -sinNode * sinPeri + cosNode * cosPeri * cosI);
+    float a = aOrbit.x;
+    vec3 orbitPos = a * (cos(E) - e) * toPeriapsis + a * sqrt(1.0 - e * e) * sin(E) * ahead;
+
+    // tumble about the rock's own axis (Rodrigues' rotation)
+    vec2 axisXZ = aLook.xy * 2.0 - 1.0;
+    vec3 axis = vec3(axisXZ.x, sqrt(max(1.0 - dot(axisXZ, axisXZ), 0.0)), axisXZ.y);
+    float spin = TWO_PI * fract(aOrbit.w * time / TWO_PI);
+    float c = cos(spin), s = sin(spin);
+    vec3 rock = aPos * (aLook.z * maxRadius);
+    rock = rock * c + cross(axis, rock) * s + axis * dot(axis, rock) * (1.0 - c);
+
+    vec3 worldPos = center + orbitPos + rock;
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+    FragPos = worldPos;
+    Shade = aLook.w;
+}
@@ -2,13 +2,18 @@
 
 in vec3 bNormal;
 in vec3 FragPos;
-in vec2 TextureCoord;
+in vec3 TextureCoord;
 
 out vec4 FragColor;
 
-uniform sampler2D ourTexture;
-uniform vec3 lightPos;
-uniform vec3 viewPos;
+uniform sampler2DArray ourTexture;
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+};
 
 void main()
 {
@@ -19,12 +24,12 @@ void main()
     vec3 ambient = ambientStrength * lightColor;
 
     vec3 norm = normalize(bNormal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
     vec3 diffuse = diff * lightColor;
 
     float specularStrength = 0.3;
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = 0.0;
     if(diff > 0.0)
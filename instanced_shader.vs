@@ -0,0 +1,28 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexture;
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in float aLayer;
+
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+};
+
+out vec3 bNormal;
+out vec3 FragPos;
+out vec3 TextureCoord;
+
+void main()
+{
+    vec4 worldPos = aModel * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPos;
+    // bodies only get uniform scale and rotation, so the model matrix itself transforms normals
+    bNormal = mat3(aModel) * aNormal;
+    FragPos = vec3(worldPos);
+    TextureCoord = vec3(aTexture, aLayer);
+}
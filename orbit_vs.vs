@@ -4,8 +4,13 @@ layout (location = 0) in vec3 position;
 layout (location = 1) in vec2 aTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    vec4 lightPos;
+    vec4 viewPos;
+};
 
 
 out vec2 texCoord;
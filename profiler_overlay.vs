@@ -0,0 +1,17 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec4 aColor;
+
+// size of the viewport in pixels
+uniform vec2 viewport;
+
+out vec4 color;
+
+void main()
+{
+    // pixels from the top-left corner, +y down as stb_easy_font lays out text
+    vec2 ndc = position.xy / viewport * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    color = aColor;
+}
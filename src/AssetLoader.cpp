@@ -0,0 +1,331 @@
+#include "AssetLoader.h"
+
+#include "Trace.h"
+
+#include "stb_image.h"
+#include "STB/stb_image_resize2.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+// a baked .dds is only used while it is at least as new as the image it was baked from
+static bool bakedIsCurrent(const std::string& path, const std::string& baked)
+{
+    std::error_code error;
+    auto bakedTime = std::filesystem::last_write_time(baked, error);
+    if (error)
+        return false;
+    auto sourceTime = std::filesystem::last_write_time(path, error);
+    if (!error && sourceTime > bakedTime)
+    {
+        std::cout << "AssetLoader: " << baked << " is older than " << path << ", loading the source (rerun bake_textures)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+AssetLoader::AssetLoader(bool baked)
+    : m_Completed(nullptr), m_CompressedTextures(baked), m_Start(std::chrono::steady_clock::now())
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    // decodes in flight still write into their jobs
+    JobSystem::global().wait(m_Decoding);
+
+    // every job is still in m_Jobs until it is delivered, whether queued, decoding or decoded
+    for (auto& entry : m_Jobs)
+    {
+        if (!entry.second->image.mapped)
+            stbi_image_free(entry.second->image.pixels);
+        delete entry.second;
+    }
+}
+
+AssetLoader::Job* AssetLoader::findOrQueue(const std::string& path, int desiredChannels, int width, int height)
+{
+    std::string key = path + "|" + std::to_string(desiredChannels) + "|" + std::to_string(width) + "x" + std::to_string(height);
+    Job*& job = m_Jobs[key];
+    if (job)
+        return job;
+
+    job = new Job();
+    job->sourcePath = path;
+    job->desiredChannels = desiredChannels;
+    job->targetWidth = width;
+    job->targetHeight = height;
+
+    const AssetPack& pack = AssetPack::mounted();
+    const PackEntry* entry = m_CompressedTextures ? pack.lookup(bakedPath(path), path) : nullptr;
+    if (entry)
+    {
+        // nothing to decode: the payload is used where the pack is mapped
+        DDSInfo info;
+        const unsigned char* payload = parseDDS(pack.data(*entry), (size_t)entry->size, info);
+        if (payload)
+        {
+            DecodedImage& image = job->image;
+            image.path = bakedPath(path);
+            image.pixels = (unsigned char*)payload;
+            image.mapped = true;
+            image.width = info.width;
+            image.height = info.height;
+            image.channels = info.format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 3 : 4;
+            image.compressedFormat = info.format;
+            image.levels = info.levels;
+            image.bytes = ddsPayloadSize(info);
+            job->decoded = true;
+            return job;
+        }
+    }
+    queueDecode(job);
+    return job;
+}
+
+void AssetLoader::queueDecode(Job* job)
+{
+    const std::string& path = job->sourcePath;
+    std::string baked = bakedPath(path);
+    if (const PackEntry* entry = AssetPack::mounted().lookup(path))
+    {
+        job->image.path = path;
+        job->source = AssetPack::mounted().data(*entry);
+        job->sourceSize = (size_t)entry->size;
+    }
+    else
+    {
+        job->image.path = m_CompressedTextures && bakedIsCurrent(path, baked) ? baked : path;
+    }
+
+    JobSystem::global().run([this, job]() { decode(job); }, &m_Decoding);
+}
+
+void AssetLoader::checkCompressedTextures()
+{
+    if (!m_CompressedTextures)
+        return;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    m_CompressedTextures = false;
+    for (GLint i = 0; i < count && !m_CompressedTextures; i++)
+    {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        m_CompressedTextures = name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0;
+    }
+    if (!m_CompressedTextures)
+        std::cout << "AssetLoader: no GL_EXT_texture_compression_s3tc, loading source images instead of baked .dds" << std::endl;
+}
+
+void AssetLoader::prefetch(const std::string& path, int desiredChannels, int width, int height)
+{
+    findOrQueue(path, desiredChannels, width, height);
+}
+
+void AssetLoader::load(const std::string& path, int desiredChannels, UploadFn onReady)
+{
+    load(path, desiredChannels, 0, 0, onReady);
+}
+
+void AssetLoader::load(const std::string& path, int desiredChannels, int width, int height, UploadFn onReady)
+{
+    Job* job = findOrQueue(path, desiredChannels, width, height);
+    if (job->callbacks.empty())
+    {
+        m_Waiting++;
+        // a prefetch that already finished is only waiting for someone to claim it
+        if (job->decoded)
+            m_Ready.push_back(job);
+    }
+    job->callbacks.push_back(onReady);
+}
+
+void AssetLoader::decode(Job* job)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    DecodedImage& image = job->image;
+    TraceScope trace("decode", image.path.c_str());
+    if (!job->source && image.path.size() > 4 && image.path.compare(image.path.size() - 4, 4, ".dds") == 0)
+    {
+        // baked offline: already at its final size, just read the blocks
+        DDSInfo info;
+        image.pixels = loadDDS(image.path, info);
+        image.width = info.width;
+        image.height = info.height;
+        image.channels = info.format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 3 : 4;
+        image.compressedFormat = info.format;
+        image.levels = info.levels;
+        image.bytes = ddsPayloadSize(info);
+    }
+    else
+    {
+        int nrChannels;
+        TraceScope load("stbi_load");
+        if (job->source)
+            image.pixels = stbi_load_from_memory(job->source, (int)job->sourceSize, &image.width, &image.height, &nrChannels, job->desiredChannels);
+        else
+            image.pixels = stbi_load(image.path.c_str(), &image.width, &image.height, &nrChannels, job->desiredChannels);
+        image.channels = job->desiredChannels ? job->desiredChannels : nrChannels;
+    }
+
+    if (image.pixels && !image.compressedFormat && job->targetWidth && (image.width != job->targetWidth || image.height != job->targetHeight))
+    {
+        // stb_image_resize2 allocates with malloc too, so stbi_image_free still applies
+        TraceScope resize("resize");
+        unsigned char* resized = stbir_resize_uint8_linear(image.pixels, image.width, image.height, 0, NULL,
+            job->targetWidth, job->targetHeight, 0, (stbir_pixel_layout)image.channels);
+        stbi_image_free(image.pixels);
+        image.pixels = resized;
+        image.width = job->targetWidth;
+        image.height = job->targetHeight;
+    }
+    if (!image.compressedFormat)
+        image.bytes = (size_t)image.width * image.height * image.channels;
+
+    image.decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // lock-free push; only the GL thread pops, and it takes the whole list at once, so there is no ABA
+    Job* head = m_Completed.load(std::memory_order_relaxed);
+    do
+    {
+        job->next = head;
+    } while (!m_Completed.compare_exchange_weak(head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+size_t AssetLoader::poll()
+{
+    Job* completed = m_Completed.exchange(nullptr, std::memory_order_acquire);
+    for (; completed; completed = completed->next)
+    {
+        completed->decoded = true;
+        m_DecodeMs += completed->image.decodeMs;
+        if (!completed->callbacks.empty())
+            m_Ready.push_back(completed);
+    }
+
+    size_t uploaded = m_Ready.size();
+    std::vector<Job*> ready;
+    ready.swap(m_Ready);
+    for (Job* job : ready)
+        deliver(job);
+    return uploaded;
+}
+
+void AssetLoader::deliver(Job* job)
+{
+    if (job->image.compressedFormat && !m_CompressedTextures)
+    {
+        // picked before GL said it has no S3TC: decode the source image instead
+        if (!job->image.mapped)
+            stbi_image_free(job->image.pixels);
+        job->image = DecodedImage();
+        job->decoded = false;
+        queueDecode(job);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const DecodedImage& image = job->image;
+    TraceScope trace("upload", image.path.c_str());
+
+    if (image.pixels)
+    {
+        const void* pixels = image.pixels;
+        if (!image.mapped)
+        {
+            if (m_PBO == 0)
+                glGenBuffers(1, &m_PBO);
+
+            // respecifying the store each time orphans the previous upload instead of waiting on it
+            size_t bytes = image.bytes;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_PBO);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            void* staging = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            std::memcpy(staging, image.pixels, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            pixels = (const void*)0;
+        }
+
+        // decoded rows are tightly packed and not always 4-byte aligned
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (UploadFn& callback : job->callbacks)
+            callback(image, pixels);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        if (!image.mapped)
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        for (UploadFn& callback : job->callbacks)
+            callback(image, nullptr);
+    }
+
+    m_UploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_Uploaded++;
+    m_Waiting--;
+
+    // the image is consumed; a later load() of the same file decodes it again
+    for (auto it = m_Jobs.begin(); it != m_Jobs.end(); ++it)
+    {
+        if (it->second == job)
+        {
+            m_Jobs.erase(it);
+            break;
+        }
+    }
+    if (!job->image.mapped)
+        stbi_image_free(job->image.pixels);
+    delete job;
+}
+
+void AssetLoader::texImage2D(GLenum target, const DecodedImage& image, const void* pixels)
+{
+    if (image.compressedFormat)
+    {
+        DDSInfo info;
+        info.format = image.compressedFormat;
+        info.width = image.width;
+        info.height = image.height;
+        info.levels = image.levels;
+        for (int level = 0; level < image.levels; level++)
+        {
+            int width = std::max(1, image.width >> level);
+            int height = std::max(1, image.height >> level);
+            glCompressedTexImage2D(target, level, image.compressedFormat, width, height, 0,
+                (GLsizei)ddsLevelSize(image.compressedFormat, width, height), (const char*)pixels + ddsLevelOffset(info, level));
+        }
+        return;
+    }
+
+    GLenum format = GL_RGB;
+    if (image.channels == 1)
+        format = GL_RED;
+    else if (image.channels == 3)
+        format = GL_RGB;
+    else if (image.channels == 4)
+        format = GL_RGBA;
+    else
+        std::cout << "Unexpected nrComponents: " << image.channels << std::endl;
+
+    glTexImage2D(target, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, pixels);
+}
+
+void AssetLoader::finish()
+{
+    while (m_Waiting > 0)
+    {
+        if (poll() == 0)
+            std::this_thread::yield();
+    }
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+    std::cout << "AssetLoader: " << m_Uploaded << " images on " << JobSystem::global().workerCount() << " threads, "
+              << wallMs << " ms since start (" << m_DecodeMs << " ms of decoding, "
+              << m_UploadMs << " ms uploading)" << std::endl;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include "AssetPack.h"
+#include "DDSFile.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+struct DecodedImage
+{
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    // malloc'd by stb_image, stb_image_resize2 or loadDDS and released with stbi_image_free,
+    // unless mapped is set and it points into the mounted asset pack
+    unsigned char* pixels = nullptr;
+    bool mapped = false;
+    size_t bytes = 0;
+    // set for baked .dds files, whose pixels hold the whole BC1/BC3 mip chain
+    unsigned int compressedFormat = 0;
+    int levels = 1;
+    double decodeMs = 0.0;
+};
+
+// Decodes images as jobs on the shared JobSystem while the main thread does GL setup.
+// Finished decodes come back through a lock-free completion stack; poll() on the GL
+// thread stages each one in a pixel-unpack buffer and runs its upload callbacks.
+// When texbake has left a .dds next to an image, that is read instead: no decode,
+// no resampling and a precomputed mip chain, unless the source image is newer or GL
+// turns out to lack S3TC, in which case the source is decoded. Files in the mounted AssetPack are
+// used in place: packed .dds payloads skip the workers and the staging copy entirely.
+class AssetLoader
+{
+public:
+    // runs on the GL thread with GL_PIXEL_UNPACK_BUFFER bound and holding the image,
+    // so `pixels` is an offset to hand straight to glTexImage*; for a mapped image no buffer
+    // is bound and `pixels` is the mapping itself. image.pixels is null if decoding failed
+    typedef std::function<void(const DecodedImage& image, const void* pixels)> UploadFn;
+
+    // baked false ignores .dds files, for runs that must not depend on whether textures were baked
+    explicit AssetLoader(bool baked = true);
+    ~AssetLoader();
+
+    // start decoding now; a later load() with the same arguments picks up the result.
+    // width/height of 0 keep the native size, anything else resamples on the worker
+    void prefetch(const std::string& path, int desiredChannels, int width = 0, int height = 0);
+    void load(const std::string& path, int desiredChannels, UploadFn onReady);
+    void load(const std::string& path, int desiredChannels, int width, int height, UploadFn onReady);
+
+    // glTexImage2D for a decoded image, or every mip level through glCompressedTexImage2D for a baked one
+    static void texImage2D(GLenum target, const DecodedImage& image, const void* pixels);
+
+    // GL thread, once GL is loaded: without GL_EXT_texture_compression_s3tc baked .dds
+    // files are skipped, and any already read are decoded again from their source images
+    void checkCompressedTextures();
+
+    // GL thread: hand over finished decodes, returns how many images were uploaded
+    size_t poll();
+    // GL thread: poll until every load() so far has been uploaded, then print timings
+    void finish();
+
+private:
+    struct Job
+    {
+        DecodedImage image;
+        // as requested, before any .dds substitution
+        std::string sourcePath;
+        int desiredChannels;
+        int targetWidth;
+        int targetHeight;
+        // encoded file inside the asset pack, decoded from memory instead of from disk
+        const unsigned char* source = nullptr;
+        size_t sourceSize = 0;
+        std::vector<UploadFn> callbacks;
+        bool decoded = false;
+        Job* next = nullptr;
+    };
+
+    // decodes that have been started and not yet pushed onto m_Completed
+    JobSystem::Counter m_Decoding;
+
+    // finished decodes: workers push, the GL thread takes the whole list at once
+    std::atomic<Job*> m_Completed;
+
+    // everything below is only touched on the GL thread
+    std::map<std::string, Job*> m_Jobs;
+    std::vector<Job*> m_Ready;
+    size_t m_Waiting = 0;
+    unsigned int m_PBO = 0;
+    // baked .dds files are read unless turned off at construction or GL lacks S3TC
+    bool m_CompressedTextures;
+
+    std::chrono::steady_clock::time_point m_Start;
+    size_t m_Uploaded = 0;
+    double m_DecodeMs = 0.0;
+    double m_UploadMs = 0.0;
+
+    Job* findOrQueue(const std::string& path, int desiredChannels, int width, int height);
+    void queueDecode(Job* job);
+    void deliver(Job* job);
+    void decode(Job* job);
+};
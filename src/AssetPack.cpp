@@ -0,0 +1,188 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+AssetPack::AssetPack()
+    : m_Data(nullptr), m_Size(0), m_Entries(nullptr), m_EntryCount(0),
+#ifdef _WIN32
+      m_File(INVALID_HANDLE_VALUE), m_Mapping(nullptr)
+#else
+      m_File(-1)
+#endif
+{
+}
+
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+bool AssetPack::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_File == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(m_File, &fileSize);
+    m_Size = (size_t)fileSize.QuadPart;
+    m_Mapping = CreateFileMappingA(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m_Mapping)
+        m_Data = (const unsigned char*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+    m_File = ::open(path.c_str(), O_RDONLY);
+    if (m_File < 0)
+        return false;
+    struct stat info;
+    if (fstat(m_File, &info) == 0 && info.st_size > 0)
+    {
+        m_Size = (size_t)info.st_size;
+        void* mapping = mmap(NULL, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+        if (mapping != MAP_FAILED)
+            m_Data = (const unsigned char*)mapping;
+    }
+#endif
+
+    if (!m_Data || m_Size < sizeof(PackHeader))
+    {
+        close();
+        return false;
+    }
+
+    // everything the lookups touch must lie inside the file
+    const PackHeader* header = (const PackHeader*)m_Data;
+    size_t tocEnd = sizeof(PackHeader) + (size_t)header->entryCount * sizeof(PackEntry);
+    bool valid = std::memcmp(header->magic, "SSPK", 4) == 0 && header->version == Version && tocEnd <= m_Size;
+    const PackEntry* entries = (const PackEntry*)(m_Data + sizeof(PackHeader));
+    for (uint32_t i = 0; valid && i < header->entryCount; i++)
+    {
+        valid = entries[i].offset <= m_Size && entries[i].size <= m_Size - entries[i].offset
+            && (size_t)entries[i].nameOffset + entries[i].nameLength <= m_Size;
+    }
+    if (!valid)
+    {
+        close();
+        return false;
+    }
+
+    m_Entries = entries;
+    m_EntryCount = header->entryCount;
+    m_Path = path;
+    std::error_code error;
+    m_Written = std::filesystem::last_write_time(path, error);
+    m_Checked.assign(m_EntryCount, 0);
+    return true;
+}
+
+void AssetPack::close()
+{
+#ifdef _WIN32
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File != INVALID_HANDLE_VALUE)
+        CloseHandle(m_File);
+    m_Mapping = nullptr;
+    m_File = INVALID_HANDLE_VALUE;
+#else
+    if (m_Data)
+        munmap((void*)m_Data, m_Size);
+    if (m_File >= 0)
+        ::close(m_File);
+    m_File = -1;
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Entries = nullptr;
+    m_EntryCount = 0;
+    m_Path.clear();
+    m_Checked.clear();
+}
+
+std::string AssetPack::name(const PackEntry& entry) const
+{
+    return std::string((const char*)m_Data + entry.nameOffset, entry.nameLength);
+}
+
+const PackEntry* AssetPack::find(const std::string& name) const
+{
+    if (!m_Entries)
+        return nullptr;
+
+    // the tool sorts entries by name, so a binary search needs no index in memory
+    const PackEntry* end = m_Entries + m_EntryCount;
+    auto compare = [this](const PackEntry& entry, const std::string& key) {
+        return key.compare(0, std::string::npos, (const char*)m_Data + entry.nameOffset, entry.nameLength);
+    };
+    const PackEntry* it = std::lower_bound(m_Entries, end, name, [&compare](const PackEntry& entry, const std::string& key) {
+        return compare(entry, key) > 0;
+    });
+    if (it != end && compare(*it, name) == 0)
+        return it;
+    return nullptr;
+}
+
+const PackEntry* AssetPack::lookup(const std::string& name, const std::string& source) const
+{
+    const PackEntry* entry = find(name);
+    if (!entry)
+        return nullptr;
+
+    // a loose file edited after packing wins over the packed copy
+    for (const std::string& loose : { name, source })
+    {
+        if (loose.empty())
+            continue;
+        std::error_code error;
+        auto modified = std::filesystem::last_write_time(loose, error);
+        if (!error && modified > m_Written)
+        {
+            std::cout << "AssetPack: " << loose << " is newer than " << m_Path << ", not using the packed " << name << std::endl;
+            return nullptr;
+        }
+    }
+
+    // hashed once, the first time the entry is used
+    unsigned char& checked = m_Checked[entry - m_Entries];
+    if (checked == 0)
+    {
+        checked = verify(*entry) ? 1 : 2;
+        if (checked == 2)
+            std::cout << "AssetPack: " << name << " in " << m_Path << " fails its hash, not using it" << std::endl;
+    }
+    return checked == 1 ? entry : nullptr;
+}
+
+bool AssetPack::verify(const PackEntry& entry) const
+{
+    return hash(data(entry), (size_t)entry.size) == entry.hash;
+}
+
+uint64_t AssetPack::hash(const unsigned char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+AssetPack& AssetPack::mounted()
+{
+    static AssetPack pack;
+    return pack;
+}
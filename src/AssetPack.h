@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Read-only archive of shaders and baked textures, memory-mapped as one file.
+//
+// Layout (little-endian), written by the assetpack tool:
+//   PackHeader
+//   PackEntry[entryCount], sorted by name
+//   name bytes, addressed by nameOffset/nameLength (not terminated)
+//   blobs, each starting on a 64-byte boundary
+//
+// Payloads are stored exactly as the GPU wants them (shader text, .dds blocks), so
+// callers pass pointers into the mapping straight to GL without copying.
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+
+struct PackEntry
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t hash; // FNV-1a 64 of the blob
+    uint32_t nameOffset;
+    uint32_t nameLength;
+};
+
+class AssetPack
+{
+private:
+    const unsigned char* m_Data;
+    size_t m_Size;
+    const PackEntry* m_Entries;
+    uint32_t m_EntryCount;
+    std::string m_Path;
+    std::filesystem::file_time_type m_Written;
+    // per entry: 0 not yet used, 1 hash matched, 2 hash mismatch
+    mutable std::vector<unsigned char> m_Checked;
+#ifdef _WIN32
+    void* m_File;
+    void* m_Mapping;
+#else
+    int m_File;
+#endif
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+public:
+    static const uint32_t Version = 1;
+    static const size_t Alignment = 64;
+
+    AssetPack();
+    ~AssetPack();
+
+    // maps the archive; false (and an empty pack) if it is missing or malformed
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_Data != nullptr; }
+    uint32_t entryCount() const { return m_EntryCount; }
+    const PackEntry& entry(uint32_t index) const { return m_Entries[index]; }
+
+    // nullptr when the pack does not contain name
+    const PackEntry* find(const std::string& name) const;
+    // find() for loading an asset: also nullptr, with a message, when the entry fails its
+    // hash the first time it is used, or when the loose file of the same name (or `source`,
+    // the file it was baked from) changed after the pack was written. Main thread only
+    const PackEntry* lookup(const std::string& name, const std::string& source = std::string()) const;
+    const unsigned char* data(const PackEntry& entry) const { return m_Data + entry.offset; }
+    std::string name(const PackEntry& entry) const;
+
+    // recompute the content hash of one entry
+    bool verify(const PackEntry& entry) const;
+
+    static uint64_t hash(const unsigned char* data, size_t size);
+
+    // the pack consulted by Shader and AssetLoader before the loose files, unless they are
+    // newer; empty until opened
+    static AssetPack& mounted();
+};
@@ -0,0 +1,219 @@
+#include "AsteroidBelt.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace
+{
+    const double TwoPi = 6.283185307179586;
+    const double MaxEccentricity = 0.3;
+
+    // counter-based: rock i draws the same numbers whichever worker generates it
+    struct Random
+    {
+        uint64_t state;
+
+        Random(uint64_t seed, uint64_t stream) : state(seed * 0x9E3779B97F4A7C15ull ^ stream) {}
+
+        // splitmix64
+        double next()
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            z ^= z >> 31;
+            return (double)(z >> 11) * (1.0 / 9007199254740992.0);
+        }
+    };
+
+    // nearest whole number of turns per Period, so the wrapped shader time never jumps
+    double quantizeRate(double rate)
+    {
+        double step = TwoPi / AsteroidBelt::Period;
+        return std::round(rate / step) * step;
+    }
+
+    int16_t packAngle(double angle)
+    {
+        // to [-pi, pi) as a fraction of pi
+        angle = std::fmod(angle, TwoPi);
+        if (angle >= TwoPi / 2.0)
+            angle -= TwoPi;
+        else if (angle < -TwoPi / 2.0)
+            angle += TwoPi;
+        return (int16_t)std::lround(angle / (TwoPi / 2.0) * 32767.0);
+    }
+
+    uint8_t packUnit(double value)
+    {
+        return (uint8_t)std::lround(std::min(std::max(value, 0.0), 1.0) * 255.0);
+    }
+}
+
+void AsteroidBelt::generateRock(int variant, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    static const float t = 1.618034f;
+    static const float corners[12][3] = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+        {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+        {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1},
+    };
+    static const unsigned int faces[20][3] = {
+        {0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+        {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1},
+    };
+
+    // an icosahedron squashed along two axes with every corner pushed in or out a little,
+    // scaled so the widest point is at radius 1
+    Random random(0x5eed, (uint64_t)variant);
+    glm::vec3 stretch(1.0f, 0.6f + 0.3f * (float)random.next(), 0.45f + 0.35f * (float)random.next());
+    unsigned int base = (unsigned int)(vertices.size() / 3);
+    std::vector<glm::vec3> points;
+    float widest = 0.0f;
+    for (const float* corner : corners)
+    {
+        glm::vec3 point = glm::normalize(glm::vec3(corner[0], corner[1], corner[2])) * stretch * (0.75f + 0.4f * (float)random.next());
+        widest = std::max(widest, glm::length(point));
+        points.push_back(point);
+    }
+    for (const glm::vec3& point : points)
+    {
+        vertices.push_back(point.x / widest);
+        vertices.push_back(point.y / widest);
+        vertices.push_back(point.z / widest);
+    }
+    for (const unsigned int* face : faces)
+    {
+        for (int i = 0; i < 3; i++)
+            indices.push_back(base + face[i]);
+    }
+}
+
+AsteroidBelt::AsteroidBelt(const char* vsFile, const char* fsFile, size_t count, double gm, double innerRadius, double outerRadius, float maxRadius, uint32_t seed)
+    : m_Count(count), m_MaxRadius(maxRadius), m_BoundingRadius((float)(outerRadius * (1.0 + MaxEccentricity)) + maxRadius),
+      m_Shader(vsFile, fsFile)
+{
+    std::vector<AsteroidInstance> instances(count);
+    JobSystem::global().parallelFor(count, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            Random random(seed, i);
+            AsteroidInstance& rock = instances[i];
+
+            // even surface density across the belt; eccentricities and inclinations are Rayleigh
+            // distributed the way the real belt's roughly are
+            double a = std::sqrt(innerRadius * innerRadius + random.next() * (outerRadius * outerRadius - innerRadius * innerRadius));
+            double e = std::min(0.07 * std::sqrt(-2.0 * std::log(1.0 - random.next())), MaxEccentricity);
+            double inclination = std::min(0.1 * std::sqrt(-2.0 * std::log(1.0 - random.next())), 0.5);
+
+            rock.semiMajorAxis = (float)a;
+            rock.meanMotion = (float)quantizeRate(std::sqrt(gm / (a * a * a)));
+            rock.meanAnomaly = (float)(TwoPi * random.next());
+            double spin = 0.05 + 0.95 * random.next();
+            rock.spinRate = (float)quantizeRate(random.next() < 0.5 ? -spin : spin);
+            rock.eccentricity = (int16_t)std::lround(e * 32767.0);
+            rock.inclination = packAngle(inclination);
+            rock.ascendingNode = packAngle(TwoPi * random.next());
+            rock.argumentOfPeriapsis = packAngle(TwoPi * random.next());
+
+            // spin axes uniform over the upper hemisphere
+            double y = random.next();
+            double azimuth = TwoPi * random.next();
+            double across = std::sqrt(1.0 - y * y);
+            rock.spinAxis[0] = packUnit(0.5 + 0.5 * across * std::cos(azimuth));
+            rock.spinAxis[1] = packUnit(0.5 + 0.5 * across * std::sin(azimuth));
+            // mostly small rocks and a few big ones
+            rock.radius = packUnit(0.15 + 0.85 * std::pow(random.next(), 4.0));
+            rock.shade = packUnit(0.55 + 0.45 * random.next());
+        }
+    });
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (int variant = 0; variant < RockMeshes; variant++)
+        generateRock(variant, vertices, indices);
+
+    glGenBuffers(1, &m_VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &m_EBO);
+    glGenBuffers(1, &m_InstanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(AsteroidInstance), instances.data(), GL_STATIC_DRAW);
+
+    // GL 3.3 has no base instance, so each rock mesh gets its own VAO whose instance
+    // attributes start at that mesh's share of the buffer
+    glGenVertexArrays(RockMeshes, m_VAOs);
+    for (int variant = 0; variant < RockMeshes; variant++)
+    {
+        size_t first = count * variant / RockMeshes;
+        size_t base = first * sizeof(AsteroidInstance);
+
+        glBindVertexArray(m_VAOs[variant]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+        if (variant == 0)
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(AsteroidInstance), (void*)(base + offsetof(AsteroidInstance, semiMajorAxis)));
+        glVertexAttribPointer(2, 4, GL_SHORT, GL_FALSE, sizeof(AsteroidInstance), (void*)(base + offsetof(AsteroidInstance, eccentricity)));
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(AsteroidInstance), (void*)(base + offsetof(AsteroidInstance, spinAxis)));
+        for (int i = 1; i <= 3; i++)
+        {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_CenterUniform = m_Shader.uniform("center");
+    m_TimeUniform = m_Shader.uniform("time");
+    m_MaxRadiusUniform = m_Shader.uniform("maxRadius");
+}
+
+AsteroidBelt::~AsteroidBelt()
+{
+    glDeleteVertexArrays(RockMeshes, m_VAOs);
+    glDeleteBuffers(1, &m_VBO);
+    glDeleteBuffers(1, &m_EBO);
+    glDeleteBuffers(1, &m_InstanceVBO);
+}
+
+void AsteroidBelt::render(const glm::vec3& center, double time)
+{
+    if (m_Count == 0)
+        return;
+
+    m_Shader.use();
+    m_Shader.set(m_CenterUniform, center);
+    m_Shader.set(m_TimeUniform, (float)std::fmod(time, Period));
+    m_Shader.set(m_MaxRadiusUniform, m_MaxRadius);
+
+    // the rocks are closed, so half their triangles face away; culling them matters most
+    // on software rasterizers, where per-triangle setup is what a rock costs
+    glEnable(GL_CULL_FACE);
+    for (int variant = 0; variant < RockMeshes; variant++)
+    {
+        size_t first = m_Count * variant / RockMeshes;
+        size_t last = m_Count * (variant + 1) / RockMeshes;
+        if (last == first)
+            continue;
+
+        glBindVertexArray(m_VAOs[variant]);
+        glDrawElementsInstanced(GL_TRIANGLES, RockIndices, GL_UNSIGNED_INT,
+            (void*)(variant * RockIndices * sizeof(unsigned int)), (GLsizei)(last - first));
+    }
+    glBindVertexArray(0);
+    glDisable(GL_CULL_FACE);
+}
@@ -0,0 +1,74 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#pragma once
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+
+#include "shader_s.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// one rock's orbit, spin and look in 28 bytes, read by attributes 1-3 of the asteroid shader.
+// The shorts are passed through unnormalized and scaled in the shader: e / 32767 and angles
+// as fractions of pi, which avoids GL 3.3's off-by-half signed normalization
+struct AsteroidInstance
+{
+    float semiMajorAxis;
+    float meanMotion;
+    float meanAnomaly;
+    float spinRate;
+    int16_t eccentricity;
+    int16_t inclination;
+    int16_t ascendingNode;
+    int16_t argumentOfPeriapsis;
+    // unsigned normalized: spin axis x and z (y is the positive remainder), radius as a fraction of the largest, brightness
+    uint8_t spinAxis[2];
+    uint8_t radius;
+    uint8_t shade;
+};
+
+// A belt of up to a million small rocks on Kepler orbits around the sun.
+// Orbits are generated once into a static instance buffer and the vertex shader solves
+// Kepler's equation for every rock from the frame time, so nothing is uploaded per frame.
+// The rocks share a few randomly displaced icosahedra, drawn with one instanced call each.
+class AsteroidBelt
+{
+public:
+    static const int RockMeshes = 4;
+    static const int RockIndices = 60;
+    // mean motions and spin rates are whole multiples of 2 pi / Period, so the time handed
+    // to the shader can wrap to [0, Period) without a jump and still fit a float
+    static constexpr double Period = 36000.0;
+
+private:
+    unsigned int m_VBO;
+    unsigned int m_EBO;
+    unsigned int m_InstanceVBO;
+    unsigned int m_VAOs[RockMeshes];
+
+    size_t m_Count;
+    float m_MaxRadius;
+    float m_BoundingRadius;
+
+    UniformHandle m_CenterUniform;
+    UniformHandle m_TimeUniform;
+    UniformHandle m_MaxRadiusUniform;
+
+    static void generateRock(int variant, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+public:
+    Shader m_Shader;
+
+    // count rocks between innerRadius and outerRadius of a body with this G*M, none reaching further than maxRadius from its centre
+    AsteroidBelt(const char* vsFile, const char* fsFile, size_t count, double gm, double innerRadius, double outerRadius, float maxRadius, uint32_t seed = 1);
+    ~AsteroidBelt();
+
+    size_t count() const { return m_Count; }
+    // no rock ever gets further than this from the sun
+    float boundingRadius() const { return m_BoundingRadius; }
+
+    // center is the sun's position relative to the camera
+    void render(const glm::vec3& center, double time);
+};
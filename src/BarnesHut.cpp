@@ -0,0 +1,447 @@
+#include "BarnesHut.h"
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+    // Morton codes use 21 bits per axis; a cell at level L is identified by the top 3L bits
+    const int MaxLevel = 21;
+
+    // threads that can work on one build or walk: every worker plus the caller
+    size_t threadCount()
+    {
+        return JobSystem::global().workerCount() + 1;
+    }
+
+    // sort each thread's share, then merge neighbouring runs pairwise
+    void parallelSort(std::vector<std::pair<uint64_t, uint32_t>>& keys)
+    {
+        size_t chunks = threadCount();
+        size_t chunkSize = (keys.size() + chunks - 1) / chunks;
+        if (chunks == 1 || keys.size() < 4096)
+        {
+            std::sort(keys.begin(), keys.end());
+            return;
+        }
+
+        auto bound = [&](size_t chunk) { return keys.begin() + std::min(keys.size(), chunk * chunkSize); };
+        JobSystem::global().parallelFor(chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; c++)
+                std::sort(bound(c), bound(c + 1));
+        });
+        for (size_t width = 1; width < chunks; width *= 2)
+        {
+            size_t pairs = (chunks + 2 * width - 1) / (2 * width);
+            JobSystem::global().parallelFor(pairs, 1, [&](size_t begin, size_t end) {
+                for (size_t p = begin; p < end; p++)
+                {
+                    size_t first = p * 2 * width;
+                    std::inplace_merge(bound(first), bound(std::min(chunks, first + width)), bound(std::min(chunks, first + 2 * width)));
+                }
+            });
+        }
+    }
+
+    // spread the low 21 bits of v so there are two zero bits between each
+    uint64_t expandBits(uint64_t v)
+    {
+        v &= 0x1FFFFF;
+        v = (v | v << 32) & 0x1F00000000FFFFull;
+        v = (v | v << 16) & 0x1F0000FF0000FFull;
+        v = (v | v << 8) & 0x100F00F00F00F00Full;
+        v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+        v = (v | v << 2) & 0x1249249249249249ull;
+        return v;
+    }
+}
+
+void BarnesHutTree::build(size_t n, const double* x, const double* y, const double* z, const double* mass)
+{
+    m_Nodes.clear();
+    if (n == 0)
+        return;
+
+    // bounding cube, padded so the far faces still quantize inside the grid
+    double minX = x[0], minY = y[0], minZ = z[0], maxX = x[0], maxY = y[0], maxZ = z[0];
+    for (size_t i = 1; i < n; i++)
+    {
+        minX = std::min(minX, x[i]);
+        maxX = std::max(maxX, x[i]);
+        minY = std::min(minY, y[i]);
+        maxY = std::max(maxY, y[i]);
+        minZ = std::min(minZ, z[i]);
+        maxZ = std::max(maxZ, z[i]);
+    }
+    double halfSize = 0.5 * std::max(std::max(maxX - minX, maxY - minY), std::max(maxZ - minZ, 1e-12)) * (1.0 + 1e-9);
+    double centerX = 0.5 * (minX + maxX), centerY = 0.5 * (minY + maxY), centerZ = 0.5 * (minZ + maxZ);
+    double originX = centerX - halfSize, originY = centerY - halfSize, originZ = centerZ - halfSize;
+    double scale = (double)(1u << MaxLevel) / (2.0 * halfSize);
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys(n);
+    JobSystem::global().parallelFor(n, 16384, [&](size_t begin, size_t end) {
+        const uint64_t maxCell = (1u << MaxLevel) - 1;
+        for (size_t i = begin; i < end; i++)
+        {
+            uint64_t qx = std::min(maxCell, (uint64_t)((x[i] - originX) * scale));
+            uint64_t qy = std::min(maxCell, (uint64_t)((y[i] - originY) * scale));
+            uint64_t qz = std::min(maxCell, (uint64_t)((z[i] - originZ) * scale));
+            keys[i] = std::make_pair(expandBits(qx) << 2 | expandBits(qy) << 1 | expandBits(qz), (uint32_t)i);
+        }
+    });
+    parallelSort(keys);
+
+    m_X.resize(n);
+    m_Y.resize(n);
+    m_Z.resize(n);
+    m_Mass.resize(n);
+    m_Codes.resize(n);
+    m_Index.resize(n);
+    JobSystem::global().parallelFor(n, 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t source = keys[i].second;
+            m_Codes[i] = keys[i].first;
+            m_Index[i] = source;
+            m_X[i] = x[source];
+            m_Y[i] = y[source];
+            m_Z[i] = z[source];
+            m_Mass[i] = mass[source];
+        }
+    });
+
+    Node root = {};
+    root.centerX = centerX;
+    root.centerY = centerY;
+    root.centerZ = centerZ;
+    root.halfSize = halfSize;
+    root.count = (uint32_t)n;
+    m_Nodes.reserve(n / leafSize * 2 + 1);
+    m_Nodes.push_back(root);
+
+    // split the top levels breadth-first until there are enough subtrees to keep every core busy
+    size_t wanted = 8 * threadCount();
+    std::vector<uint32_t> frontier(1, 0), inner;
+    int level = 0;
+    while (!frontier.empty() && frontier.size() < wanted && level < MaxLevel)
+    {
+        std::vector<uint32_t> next;
+        for (uint32_t node : frontier)
+        {
+            if (m_Nodes[node].count <= leafSize)
+            {
+                finishNode(m_Nodes, node);
+                continue;
+            }
+            createChildren(m_Nodes, node, level);
+            inner.push_back(node);
+            for (uint32_t c = 0; c < m_Nodes[node].childCount; c++)
+                next.push_back(m_Nodes[node].firstChild + c);
+        }
+        frontier.swap(next);
+        level++;
+    }
+
+    // each remaining subtree is built into its own pool, then appended with its indices shifted
+    std::vector<std::vector<Node>> subtrees(frontier.size());
+    JobSystem::global().parallelFor(frontier.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; f++)
+        {
+            std::vector<Node>& pool = subtrees[f];
+            pool.reserve(m_Nodes[frontier[f]].count / leafSize * 2 + 1);
+            pool.push_back(m_Nodes[frontier[f]]);
+            split(pool, 0, level);
+        }
+    });
+    for (size_t f = 0; f < frontier.size(); f++)
+    {
+        std::vector<Node>& pool = subtrees[f];
+        uint32_t base = (uint32_t)m_Nodes.size() - 1;
+        for (Node& node : pool)
+        {
+            if (node.firstChild)
+                node.firstChild += base;
+        }
+        m_Nodes[frontier[f]] = pool[0];
+        m_Nodes.insert(m_Nodes.end(), pool.begin() + 1, pool.end());
+    }
+
+    // the top levels were created parents first, so finish them children first
+    for (auto it = inner.rbegin(); it != inner.rend(); ++it)
+        finishNode(m_Nodes, *it);
+}
+
+void BarnesHutTree::split(std::vector<Node>& pool, uint32_t node, int level) const
+{
+    if (pool[node].count <= leafSize || level >= MaxLevel)
+    {
+        finishNode(pool, node);
+        return;
+    }
+
+    createChildren(pool, node, level);
+    uint32_t firstChild = pool[node].firstChild;
+    for (uint32_t c = 0; c < pool[node].childCount; c++)
+        split(pool, firstChild + c, level + 1);
+    finishNode(pool, node);
+}
+
+void BarnesHutTree::createChildren(std::vector<Node>& pool, uint32_t node, int level) const
+{
+    // the bodies are sorted, so each octant of this cell is a contiguous run
+    const int shift = 3 * (MaxLevel - 1 - level);
+    const uint32_t begin = pool[node].begin, end = begin + pool[node].count;
+    const double childHalf = 0.5 * pool[node].halfSize;
+    const uint32_t firstChild = (uint32_t)pool.size();
+
+    uint32_t cursor = begin;
+    for (uint32_t octant = 0; octant < 8 && cursor < end; octant++)
+    {
+        uint32_t octantEnd = (uint32_t)(std::partition_point(m_Codes.begin() + cursor, m_Codes.begin() + end,
+            [&](uint64_t code) { return ((code >> shift) & 7) <= octant; }) - m_Codes.begin());
+        if (octantEnd == cursor)
+            continue;
+
+        Node child = {};
+        child.centerX = pool[node].centerX + ((octant & 4) ? childHalf : -childHalf);
+        child.centerY = pool[node].centerY + ((octant & 2) ? childHalf : -childHalf);
+        child.centerZ = pool[node].centerZ + ((octant & 1) ? childHalf : -childHalf);
+        child.halfSize = childHalf;
+        child.begin = cursor;
+        child.count = octantEnd - cursor;
+        pool.push_back(child);
+        cursor = octantEnd;
+    }
+    pool[node].firstChild = firstChild;
+    pool[node].childCount = (uint32_t)pool.size() - firstChild;
+}
+
+void BarnesHutTree::finishNode(std::vector<Node>& pool, uint32_t index) const
+{
+    Node& node = pool[index];
+    double mass = 0.0, mx = 0.0, my = 0.0, mz = 0.0;
+    if (node.firstChild)
+    {
+        for (uint32_t c = 0; c < node.childCount; c++)
+        {
+            const Node& child = pool[node.firstChild + c];
+            mass += child.mass;
+            mx += child.mass * child.comX;
+            my += child.mass * child.comY;
+            mz += child.mass * child.comZ;
+        }
+    }
+    else
+    {
+        for (uint32_t i = node.begin; i < node.begin + node.count; i++)
+        {
+            mass += m_Mass[i];
+            mx += m_Mass[i] * m_X[i];
+            my += m_Mass[i] * m_Y[i];
+            mz += m_Mass[i] * m_Z[i];
+        }
+    }
+
+    node.mass = mass;
+    if (mass > 0.0)
+    {
+        node.comX = mx / mass;
+        node.comY = my / mass;
+        node.comZ = mz / mass;
+    }
+    else
+    {
+        node.comX = node.centerX;
+        node.comY = node.centerY;
+        node.comZ = node.centerZ;
+    }
+}
+
+void BarnesHutTree::accelerationAt(double px, double py, double pz, double theta, double eps2, double& ax, double& ay, double& az) const
+{
+    ax = ay = az = 0.0;
+    if (m_Nodes.empty())
+        return;
+
+    const double theta2 = theta * theta;
+    // depth is at most MaxLevel, with at most 7 siblings pending per level
+    uint32_t stack[8 * (MaxLevel + 1)];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0)
+    {
+        const Node& node = m_Nodes[stack[--top]];
+        double dx = node.comX - px;
+        double dy = node.comY - py;
+        double dz = node.comZ - pz;
+        double d2 = dx * dx + dy * dy + dz * dz;
+        double width = 2.0 * node.halfSize;
+
+        // a cell that contains the point is always opened, however far away its centre of mass is
+        bool inside = std::fabs(px - node.centerX) <= node.halfSize && std::fabs(py - node.centerY) <= node.halfSize
+            && std::fabs(pz - node.centerZ) <= node.halfSize;
+        if (!inside && width * width < theta2 * d2)
+        {
+            double invR = 1.0 / std::sqrt(d2 + eps2);
+            double s = node.mass * invR * invR * invR;
+            ax += s * dx;
+            ay += s * dy;
+            az += s * dz;
+        }
+        else if (!node.firstChild)
+        {
+            for (uint32_t j = node.begin; j < node.begin + node.count; j++)
+            {
+                double bx = m_X[j] - px;
+                double by = m_Y[j] - py;
+                double bz = m_Z[j] - pz;
+                double invR = 1.0 / std::sqrt(bx * bx + by * by + bz * bz + eps2);
+                double s = m_Mass[j] * invR * invR * invR;
+                ax += s * bx;
+                ay += s * by;
+                az += s * bz;
+            }
+        }
+        else
+        {
+            for (uint32_t c = 0; c < node.childCount; c++)
+                stack[top++] = node.firstChild + c;
+        }
+    }
+}
+
+// sources for one group: its own bodies first, as the kernel's targets, then whatever
+// else the walk reached; reused from group to group so it only grows
+struct BarnesHutTree::InteractionList
+{
+    std::vector<double> x, y, z, mass;
+    std::vector<double> ax, ay, az;
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        mass.clear();
+    }
+    void add(double px, double py, double pz, double m)
+    {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+        mass.push_back(m);
+    }
+};
+
+void BarnesHutTree::collectGroups(std::vector<uint32_t>& groups) const
+{
+    groups.clear();
+    if (m_Nodes.empty())
+        return;
+
+    std::vector<uint32_t> stack(1, 0);
+    while (!stack.empty())
+    {
+        uint32_t index = stack.back();
+        stack.pop_back();
+        const Node& node = m_Nodes[index];
+        if (node.count <= groupSize || !node.firstChild)
+        {
+            groups.push_back(index);
+            continue;
+        }
+        // reversed, so the first octant comes off the stack first
+        for (uint32_t c = node.childCount; c-- > 0;)
+            stack.push_back(node.firstChild + c);
+    }
+}
+
+void BarnesHutTree::walkGroup(uint32_t group, double theta2, double eps2, InteractionList& list, double* ax, double* ay, double* az) const
+{
+    const Node& targets = m_Nodes[group];
+    const uint32_t begin = targets.begin, count = targets.count;
+
+    list.clear();
+    double minX = m_X[begin], minY = m_Y[begin], minZ = m_Z[begin];
+    double maxX = minX, maxY = minY, maxZ = minZ;
+    for (uint32_t i = begin; i < begin + count; i++)
+    {
+        list.add(m_X[i], m_Y[i], m_Z[i], m_Mass[i]);
+        minX = std::min(minX, m_X[i]);
+        maxX = std::max(maxX, m_X[i]);
+        minY = std::min(minY, m_Y[i]);
+        maxY = std::max(maxY, m_Y[i]);
+        minZ = std::min(minZ, m_Z[i]);
+        maxZ = std::max(maxZ, m_Z[i]);
+    }
+
+    // depth is at most MaxLevel, with at most 7 siblings pending per level
+    uint32_t stack[8 * (MaxLevel + 1)];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        uint32_t index = stack[--top];
+        // the group's own bodies are already in the list
+        if (index == group)
+            continue;
+
+        const Node& node = m_Nodes[index];
+        double dx = std::max(std::max(minX - node.comX, node.comX - maxX), 0.0);
+        double dy = std::max(std::max(minY - node.comY, node.comY - maxY), 0.0);
+        double dz = std::max(std::max(minZ - node.comZ, node.comZ - maxZ), 0.0);
+        double d2 = dx * dx + dy * dy + dz * dz;
+        double width = 2.0 * node.halfSize;
+
+        // a cell that overlaps the group's box is always opened, however far away its centre of mass is
+        bool overlaps = node.centerX - node.halfSize <= maxX && node.centerX + node.halfSize >= minX
+            && node.centerY - node.halfSize <= maxY && node.centerY + node.halfSize >= minY
+            && node.centerZ - node.halfSize <= maxZ && node.centerZ + node.halfSize >= minZ;
+        if (!overlaps && width * width < theta2 * d2)
+        {
+            list.add(node.comX, node.comY, node.comZ, node.mass);
+        }
+        else if (!node.firstChild)
+        {
+            for (uint32_t j = node.begin; j < node.begin + node.count; j++)
+                list.add(m_X[j], m_Y[j], m_Z[j], m_Mass[j]);
+        }
+        else
+        {
+            for (uint32_t c = 0; c < node.childCount; c++)
+                stack[top++] = node.firstChild + c;
+        }
+    }
+
+    // each target's own entry sits at zero distance, and the softening makes it vanish
+    list.ax.resize(count);
+    list.ay.resize(count);
+    list.az.resize(count);
+    kernel(0, count, list.mass.size(), list.x.data(), list.y.data(), list.z.data(), list.mass.data(), eps2,
+        list.ax.data(), list.ay.data(), list.az.data());
+    for (uint32_t k = 0; k < count; k++)
+    {
+        uint32_t target = m_Index[begin + k];
+        ax[target] = list.ax[k];
+        ay[target] = list.ay[k];
+        az[target] = list.az[k];
+    }
+}
+
+void BarnesHutTree::accelerations(double theta, double eps2, double* ax, double* ay, double* az) const
+{
+    std::vector<uint32_t> groups;
+    collectGroups(groups);
+
+    // in Morton order, so consecutive groups in a chunk walk mostly the same nodes
+    const double theta2 = theta * theta;
+    JobSystem::global().parallelFor(groups.size(), 16, [&](size_t begin, size_t end) {
+        InteractionList list;
+        for (size_t g = begin; g < end; g++)
+            walkGroup(groups[g], theta2, eps2, list, ax, ay, az);
+    });
+}
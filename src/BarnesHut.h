@@ -0,0 +1,66 @@
+#pragma once
+
+#include "GravityKernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Barnes-Hut octree for O(N log N) gravity, rebuilt from scratch every step.
+// Bodies are sorted by 63-bit Morton code and copied into tree order, so every
+// node covers a contiguous run of them. Nodes live in one flat array; a node's
+// children sit next to each other in octant order. The subtrees below the top
+// levels are built in parallel. The walk is shared by groups of up to groupSize
+// bodies that are contiguous in Morton order: each group walks the tree once, with
+// the opening test taken against the group's bounding box, into one interaction list
+// of bodies and cell centres of mass that the direct SIMD kernel then evaluates for
+// every body in the group. Groups run in parallel.
+class BarnesHutTree
+{
+public:
+    struct Node
+    {
+        double comX, comY, comZ, mass;
+        double centerX, centerY, centerZ, halfSize;
+        uint32_t firstChild; // 0 for leaves; the root is never anyone's child
+        uint32_t childCount;
+        uint32_t begin;      // bodies [begin, begin + count) in tree order
+        uint32_t count;
+    };
+
+    // bodies per leaf before it is split
+    uint32_t leafSize = 8;
+    // the largest subtree whose bodies share one walk and one interaction list
+    uint32_t groupSize = 64;
+    // evaluates the interaction lists; the widest this CPU supports unless set
+    GravityKernelFn kernel = gravityKernel(detectSimdLevel());
+
+    void build(size_t n, const double* x, const double* y, const double* z, const double* mass);
+
+    // accelerations for the bodies passed to build(), in their original order.
+    // A node is replaced by its centre of mass when its width is below theta times
+    // its distance from the nearest point of a group's bounding box; theta = 0
+    // degenerates to direct summation
+    void accelerations(double theta, double eps2, double* ax, double* ay, double* az) const;
+    // the same for a single point, e.g. to compare against a reference
+    void accelerationAt(double px, double py, double pz, double theta, double eps2, double& ax, double& ay, double& az) const;
+
+    const std::vector<Node>& nodes() const { return m_Nodes; }
+
+private:
+    struct InteractionList;
+
+    std::vector<Node> m_Nodes;
+    // body data in tree (Morton) order, and where each came from
+    std::vector<double> m_X, m_Y, m_Z, m_Mass;
+    std::vector<uint64_t> m_Codes;
+    std::vector<uint32_t> m_Index;
+
+    // builds the subtree below `node`, which sits at depth `level`
+    void split(std::vector<Node>& pool, uint32_t node, int level) const;
+    void createChildren(std::vector<Node>& pool, uint32_t node, int level) const;
+    void finishNode(std::vector<Node>& pool, uint32_t node) const;
+    // the topmost nodes with at most groupSize bodies (or leaves), in Morton order
+    void collectGroups(std::vector<uint32_t>& groups) const;
+    void walkGroup(uint32_t group, double theta2, double eps2, InteractionList& list, double* ax, double* ay, double* az) const;
+};
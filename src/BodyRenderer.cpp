@@ -0,0 +1,213 @@
+#include "BodyRenderer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+BodyRenderer::BodyRenderer(const char* vsFile, const char* fsFile, const std::vector<std::string>& texFiles, AssetLoader& loader, int layerWidth, int layerHeight)
+    : m_InstanceCapacity(0), m_PixelScale(0.0f), m_LayerWidth(layerWidth), m_LayerHeight(layerHeight), m_LayerCount(0), m_ArrayFormat(0), m_ArrayLevels(1), m_Shader(vsFile, fsFile)
+{
+    initTextures(texFiles, loader);
+
+    glGenVertexArrays(SphereLOD::Levels, m_VAOs);
+    glGenBuffers(1, &m_InstanceVBO);
+
+    for (int level = 0; level < SphereLOD::Levels; level++)
+    {
+        m_Meshes[level] = SphereLOD::mesh(level);
+
+        glBindVertexArray(m_VAOs[level]);
+        m_Meshes[level]->setupAttributes();
+
+        glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+        setInstanceAttributes(0);
+        for (int i = 3; i <= 7; i++)
+        {
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 1);
+        }
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_Shader.use();
+    m_Shader.setInt("ourTexture", 0);
+}
+
+BodyRenderer::~BodyRenderer()
+{
+}
+
+void BodyRenderer::setInstanceAttributes(size_t offset)
+{
+    // a mat4 attribute takes four consecutive locations, one per column
+    for (int i = 0; i < 4; i++)
+        glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(BodyInstance), (void*)(offset + i * sizeof(glm::vec4)));
+    glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(BodyInstance), (void*)(offset + offsetof(BodyInstance, layer)));
+}
+
+void BodyRenderer::setProjection(const glm::mat4& projection, int viewportHeight)
+{
+    m_PixelScale = SphereLOD::pixelScale(projection, viewportHeight);
+}
+
+void BodyRenderer::initTextures(const std::vector<std::string>& texFiles, AssetLoader& loader)
+{
+    glGenTextures(1, &m_TextureArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_TextureArray);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    m_LayerCount = (int)texFiles.size();
+
+    // the renderer outlives the loader's startup work, so callbacks can point back at it
+    for (size_t layer = 0; layer < texFiles.size(); layer++)
+    {
+        loader.load(texFiles[layer], 3, m_LayerWidth, m_LayerHeight, [this, layer](const DecodedImage& image, const void* pixels) {
+            uploadLayer((int)layer, image, pixels);
+        });
+    }
+}
+
+void BodyRenderer::uploadLayer(int layer, const DecodedImage& image, const void* pixels)
+{
+    if (!image.pixels)
+    {
+        std::cout << "Texture failed to load at path: " << image.path << std::endl;
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_TextureArray);
+
+    if (m_ArrayFormat == 0)
+    {
+        // allocating with a NULL pointer must not read from the loader's staging buffer
+        GLint stagingBuffer = 0;
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &stagingBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        if (image.compressedFormat)
+        {
+            m_ArrayFormat = image.compressedFormat;
+            m_ArrayLevels = image.levels;
+            for (int level = 0; level < m_ArrayLevels; level++)
+            {
+                int width = std::max(1, m_LayerWidth >> level);
+                int height = std::max(1, m_LayerHeight >> level);
+                glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, m_ArrayFormat, width, height, m_LayerCount, 0,
+                    (GLsizei)(ddsLevelSize(m_ArrayFormat, width, height) * m_LayerCount), NULL);
+            }
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, m_ArrayLevels - 1);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        else
+        {
+            m_ArrayFormat = GL_RGB8;
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, m_LayerWidth, m_LayerHeight, m_LayerCount, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+    }
+
+    unsigned int format = image.compressedFormat ? image.compressedFormat : GL_RGB8;
+    if (format != m_ArrayFormat || image.levels != m_ArrayLevels || image.width != m_LayerWidth || image.height != m_LayerHeight)
+    {
+        std::cout << "Texture does not match the other layers (bake all of them with texbake --size "
+                  << m_LayerWidth << "x" << m_LayerHeight << "): " << image.path << std::endl;
+        return;
+    }
+
+    if (image.compressedFormat)
+    {
+        DDSInfo info;
+        info.format = image.compressedFormat;
+        info.width = image.width;
+        info.height = image.height;
+        info.levels = image.levels;
+        for (int level = 0; level < image.levels; level++)
+        {
+            int width = std::max(1, image.width >> level);
+            int height = std::max(1, image.height >> level);
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, width, height, 1, m_ArrayFormat,
+                (GLsizei)ddsLevelSize(m_ArrayFormat, width, height), (const char*)pixels + ddsLevelOffset(info, level));
+        }
+    }
+    else
+    {
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, image.width, image.height, 1, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    }
+}
+
+void BodyRenderer::clear()
+{
+    for (std::vector<BodyInstance>& instances : m_Instances)
+        instances.clear();
+}
+
+void BodyRenderer::add(const glm::mat4& model, float radius, int layer, size_t body)
+{
+    if (body >= m_BodyLevels.size())
+        m_BodyLevels.resize(body + 1, -1);
+    int& level = m_BodyLevels[body];
+    level = SphereLOD::select(glm::vec3(model[3]), radius, m_PixelScale, level);
+
+    BodyInstance instance;
+    instance.model = glm::scale(model, glm::vec3(radius));
+    instance.layer = (float)layer;
+    m_Instances[level].push_back(instance);
+}
+
+size_t BodyRenderer::count() const
+{
+    size_t total = 0;
+    for (const std::vector<BodyInstance>& instances : m_Instances)
+        total += instances.size();
+    return total;
+}
+
+void BodyRenderer::render()
+{
+    size_t total = count();
+    if (total == 0)
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+    // grow geometrically so a steadily increasing body count reallocates rarely
+    if (total > m_InstanceCapacity)
+        m_InstanceCapacity = total * 2;
+    // respecifying the store orphans last frame's copy, so the upload never waits on its draw.
+    // Levels are stored back to back, coarsest first
+    glBufferData(GL_ARRAY_BUFFER, m_InstanceCapacity * sizeof(BodyInstance), NULL, GL_STREAM_DRAW);
+    size_t offset = 0;
+    for (const std::vector<BodyInstance>& instances : m_Instances)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, offset, instances.size() * sizeof(BodyInstance), instances.data());
+        offset += instances.size() * sizeof(BodyInstance);
+    }
+
+    m_Shader.use();
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_TextureArray);
+
+    offset = 0;
+    for (int level = 0; level < SphereLOD::Levels; level++)
+    {
+        size_t instances = m_Instances[level].size();
+        if (instances == 0)
+            continue;
+
+        glBindVertexArray(m_VAOs[level]);
+        setInstanceAttributes(offset);
+        glDrawElementsInstanced(GL_TRIANGLES, m_Meshes[level]->indexCount(), GL_UNSIGNED_INT, 0, (GLsizei)instances);
+        offset += instances * sizeof(BodyInstance);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,73 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#pragma once
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+
+#include "shader_s.h"
+#include "SphereMesh.h"
+#include "AssetLoader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// per-instance data streamed to attributes 3-7 of the instanced body shader
+struct BodyInstance
+{
+    glm::mat4 model;
+    float layer;
+    float padding[3];
+};
+
+// Draws every lit body (planets, moons) with one glDrawElementsInstanced call per
+// sphere level of detail in use, each body on the SphereLOD level its on-screen size asks for.
+// Each body picks its texture through a layer index into a GL_TEXTURE_2D_ARRAY
+// built from texFiles; the loader resamples images of other sizes to the layer size.
+// Baked .dds layers must already match it (texbake --size).
+class BodyRenderer
+{
+private:
+    std::shared_ptr<SphereMesh> m_Meshes[SphereLOD::Levels];
+
+    // one per level: GL 3.3 has no base instance, so each points its instance attributes at its own range
+    unsigned int m_VAOs[SphereLOD::Levels];
+    unsigned int m_InstanceVBO;
+    size_t m_InstanceCapacity;
+    float m_PixelScale;
+
+    unsigned int m_TextureArray;
+    int m_LayerWidth;
+    int m_LayerHeight;
+    int m_LayerCount;
+    // storage is allocated by the first layer to arrive: RGB8, or BC1/BC3 with mips when baked
+    unsigned int m_ArrayFormat;
+    int m_ArrayLevels;
+
+    std::vector<BodyInstance> m_Instances[SphereLOD::Levels];
+    // the level each body was last drawn with, by the id passed to add()
+    std::vector<int> m_BodyLevels;
+
+    void setInstanceAttributes(size_t offset);
+
+public:
+    Shader m_Shader;
+
+    BodyRenderer(const char* vsFile, const char* fsFile, const std::vector<std::string>& texFiles, AssetLoader& loader, int layerWidth = 2048, int layerHeight = 1024);
+    ~BodyRenderer();
+
+    void initTextures(const std::vector<std::string>& texFiles, AssetLoader& loader);
+    void uploadLayer(int layer, const DecodedImage& image, const void* pixels);
+
+    // what a body's size on screen is measured with when choosing its level of detail
+    void setProjection(const glm::mat4& projection, int viewportHeight);
+
+    // instances are collected every frame, then uploaded and drawn by render().
+    // model is camera-relative; body is a small id that stays the same for a body across frames
+    void clear();
+    void add(const glm::mat4& model, float radius, int layer, size_t body);
+    size_t count() const;
+    size_t count(int level) const { return m_Instances[level].size(); }
+
+    void render();
+};
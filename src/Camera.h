@@ -4,6 +4,9 @@
 #include "glm/gtc/type_ptr.hpp"
 
 
+// Position is double so the camera can sit anywhere in a large scene; rendering is
+// camera-relative, so the view matrix is rotation only and everything drawn is
+// rebased against Position on the CPU before it is converted to float.
 class Camera {
 private:
     void updateCameraVectors()
@@ -18,7 +21,7 @@ private:
     }
 
 public:
-    glm::vec3 Position;
+    glm::dvec3 Position;
     glm::vec3 Front;
     glm::vec3 Up;
     glm::vec3 Right;
@@ -30,7 +33,7 @@ public:
     float MovementSpeed;
     float MouseSensitivity;
 
-    Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
+    Camera(glm::dvec3 position, glm::vec3 up, float yaw, float pitch)
         : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(24.5f), MouseSensitivity(0.075f)
     {
         Position = position;
@@ -40,22 +43,37 @@ public:
         updateCameraVectors();
     }
 
+    // jump straight to a pose, as a scripted CameraPath does
+    void SetView(const glm::dvec3& position, float yaw, float pitch)
+    {
+        Position = position;
+        Yaw = yaw;
+        Pitch = pitch;
+        updateCameraVectors();
+    }
+
     glm::mat4 GetViewMatrix()
     {
-        return glm::lookAt(Position, Position + Front, Up);
+        return glm::lookAt(glm::vec3(0.0f), Front, Up);
+    }
+
+    // where a world-space point is relative to the camera, computed in double
+    glm::vec3 Relative(const glm::dvec3& world) const
+    {
+        return glm::vec3(world - Position);
     }
 
     void ProcessKeyboard(char direction, float deltaTime)
     {
-        float velocity = MovementSpeed * deltaTime;
+        double velocity = MovementSpeed * deltaTime;
         if (direction == 'W')
-            Position += Front * velocity;
+            Position += glm::dvec3(Front) * velocity;
         if (direction == 'S')
-            Position -= Front * velocity;
+            Position -= glm::dvec3(Front) * velocity;
         if (direction == 'A')
-            Position -= Right * velocity;
+            Position -= glm::dvec3(Right) * velocity;
         if (direction == 'D')
-            Position += Right * velocity;
+            Position += glm::dvec3(Right) * velocity;
     }
 
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true)
@@ -0,0 +1,67 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+bool CameraPath::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "CameraPath: failed to open " << path << std::endl;
+        return false;
+    }
+
+    m_Keys.clear();
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line))
+    {
+        number++;
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::istringstream fields(line);
+        Key key;
+        if (!(fields >> key.time >> key.position.x >> key.position.y >> key.position.z >> key.yaw >> key.pitch))
+        {
+            std::cout << "CameraPath: " << path << ":" << number << ": expected time x y z yaw pitch" << std::endl;
+            return false;
+        }
+        if (!m_Keys.empty() && key.time <= m_Keys.back().time)
+        {
+            std::cout << "CameraPath: " << path << ":" << number << ": keyframe times must increase" << std::endl;
+            return false;
+        }
+        m_Keys.push_back(key);
+    }
+    if (m_Keys.empty())
+    {
+        std::cout << "CameraPath: " << path << " has no keyframes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+CameraPath::Key CameraPath::sample(double time) const
+{
+    if (time <= m_Keys.front().time)
+        return m_Keys.front();
+    if (time >= m_Keys.back().time)
+        return m_Keys.back();
+
+    auto next = std::upper_bound(m_Keys.begin(), m_Keys.end(), time, [](double t, const Key& key) { return t < key.time; });
+    const Key& a = *(next - 1);
+    const Key& b = *next;
+    double f = (time - a.time) / (b.time - a.time);
+
+    Key key;
+    key.time = time;
+    key.position = glm::mix(a.position, b.position, f);
+    key.yaw = a.yaw + (b.yaw - a.yaw) * (float)f;
+    key.pitch = a.pitch + (b.pitch - a.pitch) * (float)f;
+    return key;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// A scripted camera flight for repeatable runs: keyframes of scene time, position and
+// yaw/pitch in degrees, one per line, with '#' starting a comment:
+//   0.0   25.34 28.27 60.12   -115 -30
+// The camera moves in straight lines between keyframes; before the first and after
+// the last it holds still.
+class CameraPath
+{
+public:
+    struct Key
+    {
+        double time;
+        glm::dvec3 position;
+        float yaw;
+        float pitch;
+    };
+
+    bool load(const std::string& path);
+
+    bool empty() const { return m_Keys.empty(); }
+    double startTime() const { return m_Keys.empty() ? 0.0 : m_Keys.front().time; }
+    double endTime() const { return m_Keys.empty() ? 0.0 : m_Keys.back().time; }
+
+    Key sample(double time) const;
+
+private:
+    std::vector<Key> m_Keys;
+};
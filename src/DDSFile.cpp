@@ -0,0 +1,145 @@
+#include "DDSFile.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+    const uint32_t FOURCC_DXT1 = 0x31545844;
+    const uint32_t FOURCC_DXT5 = 0x35545844;
+
+    // DDS_HEADER, little-endian, 124 bytes
+    struct DDSHeader
+    {
+        uint32_t size;
+        uint32_t flags;
+        uint32_t height;
+        uint32_t width;
+        uint32_t pitchOrLinearSize;
+        uint32_t depth;
+        uint32_t mipMapCount;
+        uint32_t reserved1[11];
+        uint32_t pfSize;
+        uint32_t pfFlags;
+        uint32_t pfFourCC;
+        uint32_t pfRGBBitCount;
+        uint32_t pfBitMasks[4];
+        uint32_t caps;
+        uint32_t caps2;
+        uint32_t caps3;
+        uint32_t caps4;
+        uint32_t reserved2;
+    };
+
+    bool parseHeader(uint32_t magic, const DDSHeader& header, DDSInfo& info)
+    {
+        if (magic != DDS_MAGIC || header.size != sizeof(DDSHeader)
+            || (header.pfFourCC != FOURCC_DXT1 && header.pfFourCC != FOURCC_DXT5))
+            return false;
+
+        info.format = header.pfFourCC == FOURCC_DXT1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        info.width = header.width;
+        info.height = header.height;
+        info.levels = std::max(1u, header.mipMapCount);
+        return true;
+    }
+}
+
+std::string bakedPath(const std::string& sourcePath)
+{
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return sourcePath + ".dds";
+    return sourcePath.substr(0, dot) + ".dds";
+}
+
+size_t ddsLevelSize(unsigned int format, int width, int height)
+{
+    size_t blockBytes = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+}
+
+size_t ddsLevelOffset(const DDSInfo& info, int level)
+{
+    size_t offset = 0;
+    for (int i = 0; i < level; i++)
+        offset += ddsLevelSize(info.format, std::max(1, info.width >> i), std::max(1, info.height >> i));
+    return offset;
+}
+
+size_t ddsPayloadSize(const DDSInfo& info)
+{
+    return ddsLevelOffset(info, info.levels);
+}
+
+bool writeDDS(const std::string& path, const DDSInfo& info, const unsigned char* payload)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+
+    DDSHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.size = sizeof(DDSHeader);
+    header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mip count, linear size
+    header.height = info.height;
+    header.width = info.width;
+    header.pitchOrLinearSize = (uint32_t)ddsLevelSize(info.format, info.width, info.height);
+    header.mipMapCount = info.levels;
+    header.pfSize = 32;
+    header.pfFlags = 0x4; // fourCC
+    header.pfFourCC = info.format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? FOURCC_DXT1 : FOURCC_DXT5;
+    header.caps = 0x1000 | 0x8 | 0x400000; // texture, complex, mipmap
+
+    bool ok = fwrite(&DDS_MAGIC, sizeof(DDS_MAGIC), 1, file) == 1
+        && fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(payload, ddsPayloadSize(info), 1, file) == 1;
+    fclose(file);
+    return ok;
+}
+
+unsigned char* loadDDS(const std::string& path, DDSInfo& info)
+{
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file)
+        return nullptr;
+
+    uint32_t magic = 0;
+    DDSHeader header;
+    if (fread(&magic, sizeof(magic), 1, file) != 1 || fread(&header, sizeof(header), 1, file) != 1
+        || !parseHeader(magic, header, info))
+    {
+        fclose(file);
+        return nullptr;
+    }
+
+    size_t bytes = ddsPayloadSize(info);
+    unsigned char* payload = (unsigned char*)malloc(bytes);
+    if (payload && fread(payload, bytes, 1, file) != 1)
+    {
+        free(payload);
+        payload = nullptr;
+    }
+    fclose(file);
+    return payload;
+}
+
+const unsigned char* parseDDS(const unsigned char* file, size_t size, DDSInfo& info)
+{
+    const size_t headerBytes = sizeof(uint32_t) + sizeof(DDSHeader);
+    if (size < headerBytes)
+        return nullptr;
+
+    uint32_t magic;
+    DDSHeader header;
+    std::memcpy(&magic, file, sizeof(magic));
+    std::memcpy(&header, file + sizeof(magic), sizeof(header));
+    if (!parseHeader(magic, header, info) || size - headerBytes < ddsPayloadSize(info))
+        return nullptr;
+    return file + headerBytes;
+}
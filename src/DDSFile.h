@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// S3TC formats from EXT_texture_compression_s3tc, which glad's core profile header leaves out
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Header fields of a single-face DXT1 (BC1) / DXT5 (BC3) .dds as written by texbake.
+// The payload is every mip level back to back, level 0 first.
+struct DDSInfo
+{
+    unsigned int format = 0; // one of the GL_COMPRESSED_*_S3TC_* enums above
+    int width = 0;
+    int height = 0;
+    int levels = 0;
+};
+
+// where texbake writes the baked version of an image: same path, extension replaced by .dds
+std::string bakedPath(const std::string& sourcePath);
+
+// bytes in one mip level of the given size
+size_t ddsLevelSize(unsigned int format, int width, int height);
+// bytes before mip `level` in the payload
+size_t ddsLevelOffset(const DDSInfo& info, int level);
+// bytes in the whole payload
+size_t ddsPayloadSize(const DDSInfo& info);
+
+bool writeDDS(const std::string& path, const DDSInfo& info, const unsigned char* payload);
+// returns the malloc'd payload (release with free), nullptr if the file is missing or not BC1/BC3
+unsigned char* loadDDS(const std::string& path, DDSInfo& info);
+// the same for a .dds already in memory: returns a pointer to the payload inside file, nullptr if it is not BC1/BC3
+const unsigned char* parseDDS(const unsigned char* file, size_t size, DDSInfo& info);
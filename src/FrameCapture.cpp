@@ -0,0 +1,261 @@
+#include "FrameCapture.h"
+
+#include "Trace.h"
+
+#include "STB/stb_image_write.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+static const char* PIPE_MODE = "wb";
+#else
+static const char* PIPE_MODE = "w";
+#endif
+
+FrameCapture::FrameCapture(int width, int height, unsigned int numBuffers, unsigned int numThreads)
+    : m_Width(width), m_Height(height), m_Slots(std::max(2u, numBuffers)), m_Start(std::chrono::steady_clock::now())
+{
+    if (numThreads == 0)
+        numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    m_MaxInFlight = numThreads * 2 + m_Slots.size();
+    m_Workers.resize(numThreads);
+
+    size_t bytes = (size_t)width * height * 4;
+    for (Slot& slot : m_Slots)
+    {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // GL rows start at the bottom; the flag is global to stb_image_write and only ever set here
+    stbi_flip_vertically_on_write(1);
+}
+
+FrameCapture::~FrameCapture()
+{
+    stopWorkers();
+    if (m_Pipe)
+        pclose(m_Pipe);
+    for (Frame* frame : m_Queue)
+        delete frame;
+    for (Frame* frame : m_Free)
+        delete frame;
+}
+
+bool FrameCapture::openDirectory(const std::string& directory)
+{
+    m_Directory = directory;
+    for (std::thread& worker : m_Workers)
+        worker = std::thread(&FrameCapture::workerLoop, this);
+    return true;
+}
+
+bool FrameCapture::openPipe(const std::string& command)
+{
+    m_Pipe = popen(command.c_str(), PIPE_MODE);
+    if (!m_Pipe)
+    {
+        std::cout << "FrameCapture: failed to start " << command << std::endl;
+        return false;
+    }
+    // one writer keeps the frames in order
+    m_Workers.resize(1);
+    m_MaxInFlight = 2 + m_Slots.size();
+    m_Workers[0] = std::thread(&FrameCapture::workerLoop, this);
+    return true;
+}
+
+void FrameCapture::capture()
+{
+    // hand over whatever the GPU has already finished, oldest first so frames stay in order
+    for (size_t i = 0; i < m_Slots.size(); i++)
+    {
+        Slot& slot = m_Slots[(m_Next + i) % m_Slots.size()];
+        if (!slot.fence)
+            continue;
+        if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            break;
+        retire(slot, false);
+    }
+
+    // the ring is full: the oldest readback has to complete before its buffer is reused
+    Slot& slot = m_Slots[m_Next];
+    if (slot.fence)
+        retire(slot, true);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = m_FrameIndex++;
+    m_Next = (m_Next + 1) % m_Slots.size();
+}
+
+void FrameCapture::retire(Slot& slot, bool wait)
+{
+    if (wait && glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        m_Stalls++;
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED)
+            ;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+
+    Frame* frame;
+    {
+        // encoders that fall behind hold the GL thread back instead of piling up frames
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_DoneCond.wait(lock, [this] { return m_InFlight < m_MaxInFlight; });
+        m_InFlight++;
+        if (m_Free.empty())
+        {
+            frame = new Frame();
+        }
+        else
+        {
+            frame = m_Free.back();
+            m_Free.pop_back();
+        }
+    }
+
+    size_t bytes = (size_t)m_Width * m_Height * 4;
+    frame->index = slot.frame;
+    frame->rgba.resize(bytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+    std::memcpy(frame->rgba.data(), pixels, bytes);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.push_back(frame);
+    }
+    m_WorkCond.notify_one();
+}
+
+void FrameCapture::encode(Frame& frame)
+{
+    int width = m_Width, height = m_Height;
+    const unsigned char* rgba = frame.rgba.data();
+
+    if (m_Pipe)
+    {
+        // BT.601 limited range yuv420p, flipped to top-down while converting
+        int chromaWidth = (width + 1) / 2, chromaHeight = (height + 1) / 2;
+        std::vector<unsigned char> yuv((size_t)width * height + 2 * (size_t)chromaWidth * chromaHeight);
+        unsigned char* yPlane = yuv.data();
+        unsigned char* uPlane = yPlane + (size_t)width * height;
+        unsigned char* vPlane = uPlane + (size_t)chromaWidth * chromaHeight;
+        for (int y = 0; y < height; y++)
+        {
+            const unsigned char* row = rgba + (size_t)(height - 1 - y) * width * 4;
+            for (int x = 0; x < width; x++)
+            {
+                const unsigned char* p = row + x * 4;
+                yPlane[(size_t)y * width + x] = (unsigned char)((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) / 256 + 16);
+                if ((x & 1) == 0 && (y & 1) == 0)
+                {
+                    size_t c = (size_t)(y / 2) * chromaWidth + x / 2;
+                    uPlane[c] = (unsigned char)((-38 * p[0] - 74 * p[1] + 112 * p[2] + 128) / 256 + 128);
+                    vPlane[c] = (unsigned char)((112 * p[0] - 94 * p[1] - 18 * p[2] + 128) / 256 + 128);
+                }
+            }
+        }
+        fwrite(yuv.data(), 1, yuv.size(), m_Pipe);
+        return;
+    }
+
+    // drop alpha in place; the framebuffer's alpha is not meaningful
+    unsigned char* rgb = frame.rgba.data();
+    for (size_t i = 0, n = (size_t)width * height; i < n; i++)
+    {
+        rgb[i * 3 + 0] = rgba[i * 4 + 0];
+        rgb[i * 3 + 1] = rgba[i * 4 + 1];
+        rgb[i * 3 + 2] = rgba[i * 4 + 2];
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%05d.png", frame.index);
+    if (!stbi_write_png((m_Directory + name).c_str(), width, height, 3, rgb, width * 3))
+        std::cout << "FrameCapture: failed to write " << m_Directory + name << std::endl;
+}
+
+void FrameCapture::workerLoop()
+{
+    Trace::setThreadName("capture");
+    for (;;)
+    {
+        Frame* frame;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkCond.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+            if (m_Queue.empty())
+                return;
+            frame = m_Queue.front();
+            m_Queue.pop_front();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            TraceScope trace("encode frame");
+            encode(*frame);
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_EncodeMs += ms;
+            m_Free.push_back(frame);
+            m_InFlight--;
+        }
+        m_DoneCond.notify_all();
+    }
+}
+
+void FrameCapture::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_WorkCond.notify_all();
+    for (std::thread& worker : m_Workers)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void FrameCapture::finish()
+{
+    // oldest first, as in capture()
+    for (size_t i = 0; i < m_Slots.size(); i++)
+    {
+        Slot& slot = m_Slots[(m_Next + i) % m_Slots.size()];
+        if (slot.fence)
+            retire(slot, true);
+    }
+    for (Slot& slot : m_Slots)
+        glDeleteBuffers(1, &slot.pbo);
+    m_Slots.clear();
+
+    // workers drain the queue before they exit
+    stopWorkers();
+    if (m_Pipe)
+    {
+        pclose(m_Pipe);
+        m_Pipe = nullptr;
+    }
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_Start).count();
+    std::cout << "FrameCapture: " << m_FrameIndex << " frames in " << wallMs << " ms ("
+              << m_FrameIndex * 1000.0 / wallMs << " fps), " << m_Stalls << " readback stalls, "
+              << m_EncodeMs << " ms encoding on " << m_Workers.size() << " threads" << std::endl;
+}
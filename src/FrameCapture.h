@@ -0,0 +1,77 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records rendered frames without stalling the pipeline.
+// capture() queues glReadPixels into the next pixel-pack buffer of a small ring and
+// fences it; the buffer is mapped a couple of frames later, once the GPU is done,
+// and its pixels go to worker threads that write numbered PNGs or convert to
+// YUV 4:2:0 and pipe raw video into an encoder process (ffmpeg -f rawvideo ...).
+class FrameCapture
+{
+public:
+    // reads the currently bound read framebuffer, width x height from the origin
+    FrameCapture(int width, int height, unsigned int numBuffers = 3, unsigned int numThreads = 0);
+    ~FrameCapture();
+
+    // <directory>/frame_NNNNN.png, encoded in parallel
+    bool openDirectory(const std::string& directory);
+    // yuv420p frames written in order to the command's stdin
+    bool openPipe(const std::string& command);
+
+    // GL thread, after the frame is drawn and before it is swapped
+    void capture();
+    // GL thread: read back everything still in flight, wait for the encoders, print timings
+    void finish();
+
+private:
+    struct Slot
+    {
+        GLuint pbo = 0;
+        GLsync fence = 0;
+        int frame = 0;
+    };
+    struct Frame
+    {
+        int index;
+        std::vector<unsigned char> rgba;
+    };
+
+    int m_Width;
+    int m_Height;
+    std::vector<Slot> m_Slots;
+    size_t m_Next = 0;
+    int m_FrameIndex = 0;
+
+    std::string m_Directory;
+    FILE* m_Pipe = nullptr;
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCond;
+    std::condition_variable m_DoneCond;
+    std::deque<Frame*> m_Queue;
+    // recycled pixel buffers, so steady-state capture does not allocate
+    std::vector<Frame*> m_Free;
+    size_t m_InFlight = 0;
+    size_t m_MaxInFlight;
+    bool m_Stopping = false;
+
+    std::chrono::steady_clock::time_point m_Start;
+    size_t m_Stalls = 0;
+    double m_EncodeMs = 0.0;
+
+    void retire(Slot& slot, bool wait);
+    void encode(Frame& frame);
+    void workerLoop();
+    void stopWorkers();
+};
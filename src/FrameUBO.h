@@ -0,0 +1,50 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+
+// std140 layout of the FrameData uniform block declared in every shader
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 viewPos;
+};
+
+// Per-frame camera and light state shared by all programs through one uniform
+// buffer, instead of setting view/projection/light on each program separately.
+class FrameUBO
+{
+private:
+    unsigned int m_UBO;
+
+public:
+    static const unsigned int Binding = 0;
+
+    FrameUBO()
+    {
+        glGenBuffers(1, &m_UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        glBindBufferBase(GL_UNIFORM_BUFFER, Binding, m_UBO);
+    }
+
+    // called once per frame before any draw
+    void update(const FrameData& data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, m_UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // GLSL 330 has no layout(binding = N), so each program is pointed at the binding after link
+    static void bindProgram(unsigned int program)
+    {
+        unsigned int blockIndex = glGetUniformBlockIndex(program, "FrameData");
+        if (blockIndex != GL_INVALID_INDEX)
+            glUniformBlockBinding(program, blockIndex, Binding);
+    }
+};
@@ -0,0 +1,86 @@
+#include "FrustumCuller.h"
+
+#include <algorithm>
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection)
+{
+    // glm is column-major: row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+    // left, right, bottom, top, near, far
+    Frustum frustum;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        frustum.planes[axis * 2] = rows[3] + rows[axis];
+        frustum.planes[axis * 2 + 1] = rows[3] - rows[axis];
+    }
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+size_t frustumCullScalar(const Frustum& frustum, size_t count, const float* x, const float* y, const float* z, const float* radius,
+    uint32_t* visible)
+{
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        bool inside = true;
+        for (const glm::vec4& plane : frustum.planes)
+        {
+            float distance = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w;
+            inside = inside && distance + radius[i] >= 0.0f;
+        }
+        // written unconditionally and only kept by advancing, so there is no branch to mispredict
+        visible[written] = (uint32_t)i;
+        written += inside ? 1 : 0;
+    }
+    return written;
+}
+
+FrustumCullFn frustumCullKernel(SimdLevel level)
+{
+#if defined(SOLAR_GRAVITY_SIMD)
+    if (level >= SimdLevel::AVX2)
+        return frustumCullAVX;
+#endif
+    return frustumCullScalar;
+}
+
+FrustumCuller::FrustumCuller()
+    : m_Kernel(frustumCullKernel(detectSimdLevel()))
+{
+}
+
+void FrustumCuller::clear()
+{
+    m_X.clear();
+    m_Y.clear();
+    m_Z.clear();
+    m_Radius.clear();
+}
+
+size_t FrustumCuller::add(const glm::vec3& center, float radius)
+{
+    m_X.push_back(center.x);
+    m_Y.push_back(center.y);
+    m_Z.push_back(center.z);
+    m_Radius.push_back(radius);
+    return m_X.size() - 1;
+}
+
+const std::vector<uint32_t>& FrustumCuller::cull(const glm::mat4& viewProjection)
+{
+    Frustum frustum = Frustum::fromMatrix(viewProjection);
+    m_Visible.resize(m_X.size());
+    size_t count = m_Kernel(frustum, m_X.size(), m_X.data(), m_Y.data(), m_Z.data(), m_Radius.data(), m_Visible.data());
+    m_Visible.resize(count);
+    return m_Visible;
+}
+
+bool FrustumCuller::isVisible(size_t index) const
+{
+    return std::binary_search(m_Visible.begin(), m_Visible.end(), (uint32_t)index);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "GravityKernel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Six planes (a, b, c, d) with unit normals pointing inwards: a point p is inside
+// when dot(abc, p) + d >= 0 for all of them, and a sphere is at least partly inside
+// while no plane has its centre further than its radius behind it.
+struct Frustum
+{
+    glm::vec4 planes[6];
+
+    // Gribb-Hartmann extraction from projection * view
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+};
+
+// appends the index of every sphere in [0, count) that is at least partly inside to visible,
+// in ascending order, and returns how many it wrote. visible needs room for count indices.
+// Every version does the same float operations in the same order, so unless the compiler
+// contracts them into FMAs they agree exactly
+typedef size_t (*FrustumCullFn)(const Frustum& frustum, size_t count, const float* x, const float* y, const float* z, const float* radius,
+    uint32_t* visible);
+
+size_t frustumCullScalar(const Frustum& frustum, size_t count, const float* x, const float* y, const float* z, const float* radius,
+    uint32_t* visible);
+// 8 spheres per iteration; compiled with -mavx, and only picked where AVX2 is (there is no plain AVX level)
+size_t frustumCullAVX(const Frustum& frustum, size_t count, const float* x, const float* y, const float* z, const float* radius,
+    uint32_t* visible);
+
+// the widest cull `level` allows
+FrustumCullFn frustumCullKernel(SimdLevel level);
+
+// Bounding spheres of everything that might be drawn this frame, kept as structure-of-arrays
+// floats. cull() tests them all against the camera and compacts the visible ones into an
+// ascending index list the draw code walks instead of drawing everything.
+class FrustumCuller
+{
+private:
+    FrustumCullFn m_Kernel;
+    std::vector<float> m_X;
+    std::vector<float> m_Y;
+    std::vector<float> m_Z;
+    std::vector<float> m_Radius;
+    std::vector<uint32_t> m_Visible;
+
+public:
+    FrustumCuller();
+
+    void clear();
+    // returns the sphere's index
+    size_t add(const glm::vec3& center, float radius);
+    size_t size() const { return m_X.size(); }
+
+    // centres are in the same space viewProjection maps from
+    const std::vector<uint32_t>& cull(const glm::mat4& viewProjection);
+    // the last cull()'s result
+    const std::vector<uint32_t>& visible() const { return m_Visible; }
+    bool isVisible(size_t index) const;
+};
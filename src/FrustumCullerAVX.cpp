@@ -0,0 +1,50 @@
+// compiled with -mavx; only called when frustumCullKernel() picks it
+#include "FrustumCuller.h"
+
+#include <immintrin.h>
+
+size_t frustumCullAVX(const Frustum& frustum, size_t count, const float* x, const float* y, const float* z, const float* radius,
+    uint32_t* visible)
+{
+    __m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+    for (int p = 0; p < 6; p++)
+    {
+        planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+        planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+        planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+        planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t written = 0;
+    const size_t body = count & ~(size_t)7;
+    for (size_t i = 0; i < body; i += 8)
+    {
+        const __m256 cx = _mm256_loadu_ps(x + i);
+        const __m256 cy = _mm256_loadu_ps(y + i);
+        const __m256 cz = _mm256_loadu_ps(z + i);
+        const __m256 r = _mm256_loadu_ps(radius + i);
+
+        // no FMA: plain multiplies and adds round the same way as the scalar loop
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(planeX[p], cx), _mm256_mul_ps(planeY[p], cy)),
+                _mm256_mul_ps(planeZ[p], cz)), planeW[p]);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, r), zero, _CMP_GE_OQ));
+        }
+
+        // compact: every lane writes its index, and only the visible ones advance the cursor
+        unsigned int mask = (unsigned int)_mm256_movemask_ps(inside);
+        for (unsigned int lane = 0; lane < 8; lane++)
+        {
+            visible[written] = (uint32_t)(i + lane);
+            written += (mask >> lane) & 1;
+        }
+    }
+
+    size_t tail = frustumCullScalar(frustum, count - body, x + body, y + body, z + body, radius + body, visible + written);
+    for (size_t k = 0; k < tail; k++)
+        visible[written + k] += (uint32_t)body;
+    return written + tail;
+}
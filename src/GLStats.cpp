@@ -0,0 +1,533 @@
+#include "GLStats.h"
+
+#include "glad/glad.h"
+
+#include <cstdio>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+
+namespace
+{
+    bool s_Installed = false;
+    GLCounters s_Counters;
+    GLFrameCalls s_Frame;
+    GLFrameCalls s_LastFrame;
+    GLFrameCalls s_Total;
+    uint64_t s_Frames = 0;
+
+    // what GL has bound right now, as far as the wrappers have seen
+    GLuint s_Program = 0;
+    GLuint s_VertexArray = 0;
+    GLenum s_ActiveUnit = GL_TEXTURE0;
+    // the element buffer belongs to the vertex array, every other target to the context
+    std::unordered_map<GLuint, GLuint> s_ElementBuffers;
+    std::unordered_map<GLenum, GLuint> s_Buffers;
+    // (unit << 32 | target) -> texture
+    std::unordered_map<uint64_t, GLuint> s_Textures;
+    // (texture << 32 | name) -> value
+    std::unordered_map<uint64_t, GLint> s_TexParameters;
+    // pixel uploads read from a pixel-unpack buffer were counted when the buffer was filled
+    GLuint s_UnpackBuffer = 0;
+
+    PFNGLDRAWARRAYSPROC s_DrawArrays;
+    PFNGLDRAWELEMENTSPROC s_DrawElements;
+    PFNGLDRAWARRAYSINSTANCEDPROC s_DrawArraysInstanced;
+    PFNGLDRAWELEMENTSINSTANCEDPROC s_DrawElementsInstanced;
+    PFNGLDRAWRANGEELEMENTSPROC s_DrawRangeElements;
+
+    PFNGLUSEPROGRAMPROC s_UseProgram;
+    PFNGLBINDVERTEXARRAYPROC s_BindVertexArray;
+    PFNGLBINDTEXTUREPROC s_BindTexture;
+    PFNGLACTIVETEXTUREPROC s_ActiveTexture;
+    PFNGLBINDBUFFERPROC s_BindBuffer;
+    PFNGLBINDBUFFERBASEPROC s_BindBufferBase;
+    PFNGLTEXPARAMETERIPROC s_TexParameteri;
+    PFNGLENABLEPROC s_Enable;
+    PFNGLDISABLEPROC s_Disable;
+    PFNGLDEPTHFUNCPROC s_DepthFunc;
+    PFNGLBLENDFUNCPROC s_BlendFunc;
+
+    PFNGLUNIFORM1IPROC s_Uniform1i;
+    PFNGLUNIFORM1FPROC s_Uniform1f;
+    PFNGLUNIFORM2FPROC s_Uniform2f;
+    PFNGLUNIFORM3FPROC s_Uniform3f;
+    PFNGLUNIFORM4FPROC s_Uniform4f;
+    PFNGLUNIFORM1IVPROC s_Uniform1iv;
+    PFNGLUNIFORM1FVPROC s_Uniform1fv;
+    PFNGLUNIFORM2FVPROC s_Uniform2fv;
+    PFNGLUNIFORM3FVPROC s_Uniform3fv;
+    PFNGLUNIFORM4FVPROC s_Uniform4fv;
+    PFNGLUNIFORMMATRIX3FVPROC s_UniformMatrix3fv;
+    PFNGLUNIFORMMATRIX4FVPROC s_UniformMatrix4fv;
+
+    PFNGLDELETEVERTEXARRAYSPROC s_DeleteVertexArrays;
+    PFNGLDELETEBUFFERSPROC s_DeleteBuffers;
+    PFNGLDELETETEXTURESPROC s_DeleteTextures;
+
+    PFNGLBUFFERDATAPROC s_BufferData;
+    PFNGLBUFFERSUBDATAPROC s_BufferSubData;
+    PFNGLMAPBUFFERRANGEPROC s_MapBufferRange;
+    PFNGLTEXIMAGE2DPROC s_TexImage2D;
+    PFNGLTEXIMAGE3DPROC s_TexImage3D;
+    PFNGLTEXSUBIMAGE3DPROC s_TexSubImage3D;
+    PFNGLCOMPRESSEDTEXIMAGE2DPROC s_CompressedTexImage2D;
+    PFNGLCOMPRESSEDTEXIMAGE3DPROC s_CompressedTexImage3D;
+    PFNGLCOMPRESSEDTEXSUBIMAGE3DPROC s_CompressedTexSubImage3D;
+
+    void record(GLCall call, bool redundant, uint64_t bytes = 0)
+    {
+        GLCallCount& counted = s_Frame.kinds[(int)call];
+        counted.calls++;
+        if (redundant)
+            counted.redundant++;
+        counted.bytes += bytes;
+    }
+
+    // records the new binding; true when it was already bound
+    template <typename Key>
+    bool rebind(std::unordered_map<Key, GLuint>& bindings, Key key, GLuint object)
+    {
+        auto it = bindings.find(key);
+        // never seen means the default, nothing bound
+        GLuint current = it == bindings.end() ? 0 : it->second;
+        if (current == object)
+            return true;
+        bindings[key] = object;
+        return false;
+    }
+
+    uint64_t textureKey(GLenum target)
+    {
+        return (uint64_t)s_ActiveUnit << 32 | target;
+    }
+
+    uint64_t pixelBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+    {
+        // a null pointer with no unpack buffer only allocates; with one, the bytes were
+        // counted as they went into the buffer
+        if (!pixels || s_UnpackBuffer != 0)
+            return 0;
+
+        uint64_t channels = 4;
+        if (format == GL_RED || format == GL_DEPTH_COMPONENT)
+            channels = 1;
+        else if (format == GL_RG)
+            channels = 2;
+        else if (format == GL_RGB || format == GL_BGR)
+            channels = 3;
+        uint64_t size = 1;
+        if (type == GL_UNSIGNED_SHORT || type == GL_SHORT || type == GL_HALF_FLOAT)
+            size = 2;
+        else if (type == GL_FLOAT || type == GL_UNSIGNED_INT || type == GL_INT)
+            size = 4;
+        return (uint64_t)width * height * depth * channels * size;
+    }
+
+    void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count)
+    {
+        s_Counters.drawCalls++;
+        record(GLCall::Draw, false);
+        s_DrawArrays(mode, first, count);
+    }
+    void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+    {
+        s_Counters.drawCalls++;
+        record(GLCall::Draw, false);
+        s_DrawElements(mode, count, type, indices);
+    }
+    void APIENTRY drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+    {
+        s_Counters.drawCalls++;
+        record(GLCall::Draw, false);
+        s_DrawArraysInstanced(mode, first, count, instances);
+    }
+    void APIENTRY drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances)
+    {
+        s_Counters.drawCalls++;
+        record(GLCall::Draw, false);
+        s_DrawElementsInstanced(mode, count, type, indices, instances);
+    }
+    void APIENTRY drawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void* indices)
+    {
+        s_Counters.drawCalls++;
+        record(GLCall::Draw, false);
+        s_DrawRangeElements(mode, start, end, count, type, indices);
+    }
+
+    void APIENTRY useProgram(GLuint program)
+    {
+        s_Counters.stateChanges++;
+        record(GLCall::UseProgram, program == s_Program);
+        s_Program = program;
+        s_UseProgram(program);
+    }
+    void APIENTRY bindVertexArray(GLuint array)
+    {
+        s_Counters.stateChanges++;
+        record(GLCall::BindVertexArray, array == s_VertexArray);
+        s_VertexArray = array;
+        s_BindVertexArray(array);
+    }
+    void APIENTRY bindTexture(GLenum target, GLuint texture)
+    {
+        s_Counters.stateChanges++;
+        record(GLCall::BindTexture, rebind(s_Textures, textureKey(target), texture));
+        s_BindTexture(target, texture);
+    }
+    void APIENTRY activeTexture(GLenum unit)
+    {
+        s_Counters.stateChanges++;
+        record(GLCall::ActiveTexture, unit == s_ActiveUnit);
+        s_ActiveUnit = unit;
+        s_ActiveTexture(unit);
+    }
+    void APIENTRY bindBuffer(GLenum target, GLuint buffer)
+    {
+        s_Counters.stateChanges++;
+        if (target == GL_PIXEL_UNPACK_BUFFER)
+            s_UnpackBuffer = buffer;
+        bool redundant = target == GL_ELEMENT_ARRAY_BUFFER ? rebind(s_ElementBuffers, s_VertexArray, buffer) : rebind(s_Buffers, target, buffer);
+        record(GLCall::BindBuffer, redundant);
+        s_BindBuffer(target, buffer);
+    }
+    void APIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        s_Counters.stateChanges++;
+        // also binds the generic target, but the indexed binding is not shadowed, so never redundant
+        s_Buffers[target] = buffer;
+        record(GLCall::BindBuffer, false);
+        s_BindBufferBase(target, index, buffer);
+    }
+    void APIENTRY texParameteri(GLenum target, GLenum name, GLint value)
+    {
+        s_Counters.stateChanges++;
+        auto bound = s_Textures.find(textureKey(target));
+        GLuint texture = bound == s_Textures.end() ? 0 : bound->second;
+        uint64_t key = (uint64_t)texture << 32 | name;
+        auto it = s_TexParameters.find(key);
+        record(GLCall::TexParameter, it != s_TexParameters.end() && it->second == value);
+        s_TexParameters[key] = value;
+        s_TexParameteri(target, name, value);
+    }
+    void APIENTRY enable(GLenum capability)
+    {
+        s_Counters.stateChanges++;
+        s_Enable(capability);
+    }
+    void APIENTRY disable(GLenum capability)
+    {
+        s_Counters.stateChanges++;
+        s_Disable(capability);
+    }
+    void APIENTRY depthFunc(GLenum func)
+    {
+        s_Counters.stateChanges++;
+        s_DepthFunc(func);
+    }
+    void APIENTRY blendFunc(GLenum source, GLenum destination)
+    {
+        s_Counters.stateChanges++;
+        s_BlendFunc(source, destination);
+    }
+
+    void APIENTRY uniform1i(GLint location, GLint v0)
+    {
+        record(GLCall::Uniform, false, sizeof(GLint));
+        s_Uniform1i(location, v0);
+    }
+    void APIENTRY uniform1f(GLint location, GLfloat v0)
+    {
+        record(GLCall::Uniform, false, sizeof(GLfloat));
+        s_Uniform1f(location, v0);
+    }
+    void APIENTRY uniform2f(GLint location, GLfloat v0, GLfloat v1)
+    {
+        record(GLCall::Uniform, false, 2 * sizeof(GLfloat));
+        s_Uniform2f(location, v0, v1);
+    }
+    void APIENTRY uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+    {
+        record(GLCall::Uniform, false, 3 * sizeof(GLfloat));
+        s_Uniform3f(location, v0, v1, v2);
+    }
+    void APIENTRY uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+    {
+        record(GLCall::Uniform, false, 4 * sizeof(GLfloat));
+        s_Uniform4f(location, v0, v1, v2, v3);
+    }
+    void APIENTRY uniform1iv(GLint location, GLsizei count, const GLint* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * sizeof(GLint));
+        s_Uniform1iv(location, count, value);
+    }
+    void APIENTRY uniform1fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * sizeof(GLfloat));
+        s_Uniform1fv(location, count, value);
+    }
+    void APIENTRY uniform2fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * 2 * sizeof(GLfloat));
+        s_Uniform2fv(location, count, value);
+    }
+    void APIENTRY uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * 3 * sizeof(GLfloat));
+        s_Uniform3fv(location, count, value);
+    }
+    void APIENTRY uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * 4 * sizeof(GLfloat));
+        s_Uniform4fv(location, count, value);
+    }
+    void APIENTRY uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * 9 * sizeof(GLfloat));
+        s_UniformMatrix3fv(location, count, transpose, value);
+    }
+    void APIENTRY uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        record(GLCall::Uniform, false, (uint64_t)count * 16 * sizeof(GLfloat));
+        s_UniformMatrix4fv(location, count, transpose, value);
+    }
+
+    // deleting an object unbinds it, and a later object may reuse its name
+    void APIENTRY deleteVertexArrays(GLsizei n, const GLuint* arrays)
+    {
+        for (GLsizei i = 0; i < n; i++)
+        {
+            if (arrays[i] == 0)
+                continue;
+            if (s_VertexArray == arrays[i])
+                s_VertexArray = 0;
+            s_ElementBuffers.erase(arrays[i]);
+        }
+        s_DeleteVertexArrays(n, arrays);
+    }
+    void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers)
+    {
+        for (GLsizei i = 0; i < n; i++)
+        {
+            if (buffers[i] == 0)
+                continue;
+            for (auto& binding : s_Buffers)
+                if (binding.second == buffers[i])
+                    binding.second = 0;
+            // only the bound vertex array loses its element buffer binding
+            auto element = s_ElementBuffers.find(s_VertexArray);
+            if (element != s_ElementBuffers.end() && element->second == buffers[i])
+                element->second = 0;
+            if (s_UnpackBuffer == buffers[i])
+                s_UnpackBuffer = 0;
+        }
+        s_DeleteBuffers(n, buffers);
+    }
+    void APIENTRY deleteTextures(GLsizei n, const GLuint* textures)
+    {
+        for (GLsizei i = 0; i < n; i++)
+        {
+            if (textures[i] == 0)
+                continue;
+            for (auto& binding : s_Textures)
+                if (binding.second == textures[i])
+                    binding.second = 0;
+            for (auto it = s_TexParameters.begin(); it != s_TexParameters.end();)
+                it = (it->first >> 32) == textures[i] ? s_TexParameters.erase(it) : std::next(it);
+        }
+        s_DeleteTextures(n, textures);
+    }
+
+    void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        record(GLCall::BufferData, false, data ? (uint64_t)size : 0);
+        if (data)
+            s_Counters.uploadedBytes += (uint64_t)size;
+        s_BufferData(target, size, data, usage);
+    }
+    void APIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        record(GLCall::BufferData, false, (uint64_t)size);
+        s_Counters.uploadedBytes += (uint64_t)size;
+        s_BufferSubData(target, offset, size, data);
+    }
+    void* APIENTRY mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        // counted when mapped: whatever is written through the mapping is an upload
+        if (access & GL_MAP_WRITE_BIT)
+            s_Counters.uploadedBytes += (uint64_t)length;
+        return s_MapBufferRange(target, offset, length, access);
+    }
+    void APIENTRY texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels)
+    {
+        s_Counters.uploadedBytes += pixelBytes(width, height, 1, format, type, pixels);
+        s_TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    }
+    void APIENTRY texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels)
+    {
+        s_Counters.uploadedBytes += pixelBytes(width, height, depth, format, type, pixels);
+        s_TexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+    }
+    void APIENTRY texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void* pixels)
+    {
+        s_Counters.uploadedBytes += pixelBytes(width, height, depth, format, type, pixels);
+        s_TexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+    }
+    void APIENTRY compressedTexImage2D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data)
+    {
+        if (s_UnpackBuffer == 0)
+            s_Counters.uploadedBytes += (uint64_t)imageSize;
+        s_CompressedTexImage2D(target, level, internalFormat, width, height, border, imageSize, data);
+    }
+    void APIENTRY compressedTexImage3D(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void* data)
+    {
+        if (data && s_UnpackBuffer == 0)
+            s_Counters.uploadedBytes += (uint64_t)imageSize;
+        s_CompressedTexImage3D(target, level, internalFormat, width, height, depth, border, imageSize, data);
+    }
+    void APIENTRY compressedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void* data)
+    {
+        if (s_UnpackBuffer == 0)
+            s_Counters.uploadedBytes += (uint64_t)imageSize;
+        s_CompressedTexSubImage3D(target, level, x, y, z, width, height, depth, format, imageSize, data);
+    }
+
+    template <typename Fn>
+    void wrap(Fn& entry, Fn& original, Fn wrapper)
+    {
+        original = entry;
+        if (entry)
+            entry = wrapper;
+    }
+}
+
+void GLStats::install()
+{
+    if (s_Installed)
+        return;
+    s_Installed = true;
+
+    wrap(glad_glDrawArrays, s_DrawArrays, &drawArrays);
+    wrap(glad_glDrawElements, s_DrawElements, &drawElements);
+    wrap(glad_glDrawArraysInstanced, s_DrawArraysInstanced, &drawArraysInstanced);
+    wrap(glad_glDrawElementsInstanced, s_DrawElementsInstanced, &drawElementsInstanced);
+    wrap(glad_glDrawRangeElements, s_DrawRangeElements, &drawRangeElements);
+
+    wrap(glad_glUseProgram, s_UseProgram, &useProgram);
+    wrap(glad_glBindVertexArray, s_BindVertexArray, &bindVertexArray);
+    wrap(glad_glBindTexture, s_BindTexture, &bindTexture);
+    wrap(glad_glActiveTexture, s_ActiveTexture, &activeTexture);
+    wrap(glad_glBindBuffer, s_BindBuffer, &bindBuffer);
+    wrap(glad_glBindBufferBase, s_BindBufferBase, &bindBufferBase);
+    wrap(glad_glTexParameteri, s_TexParameteri, &texParameteri);
+    wrap(glad_glEnable, s_Enable, &enable);
+    wrap(glad_glDisable, s_Disable, &disable);
+    wrap(glad_glDepthFunc, s_DepthFunc, &depthFunc);
+    wrap(glad_glBlendFunc, s_BlendFunc, &blendFunc);
+
+    wrap(glad_glUniform1i, s_Uniform1i, &uniform1i);
+    wrap(glad_glUniform1f, s_Uniform1f, &uniform1f);
+    wrap(glad_glUniform2f, s_Uniform2f, &uniform2f);
+    wrap(glad_glUniform3f, s_Uniform3f, &uniform3f);
+    wrap(glad_glUniform4f, s_Uniform4f, &uniform4f);
+    wrap(glad_glUniform1iv, s_Uniform1iv, &uniform1iv);
+    wrap(glad_glUniform1fv, s_Uniform1fv, &uniform1fv);
+    wrap(glad_glUniform2fv, s_Uniform2fv, &uniform2fv);
+    wrap(glad_glUniform3fv, s_Uniform3fv, &uniform3fv);
+    wrap(glad_glUniform4fv, s_Uniform4fv, &uniform4fv);
+    wrap(glad_glUniformMatrix3fv, s_UniformMatrix3fv, &uniformMatrix3fv);
+    wrap(glad_glUniformMatrix4fv, s_UniformMatrix4fv, &uniformMatrix4fv);
+
+    wrap(glad_glDeleteVertexArrays, s_DeleteVertexArrays, &deleteVertexArrays);
+    wrap(glad_glDeleteBuffers, s_DeleteBuffers, &deleteBuffers);
+    wrap(glad_glDeleteTextures, s_DeleteTextures, &deleteTextures);
+
+    wrap(glad_glBufferData, s_BufferData, &bufferData);
+    wrap(glad_glBufferSubData, s_BufferSubData, &bufferSubData);
+    wrap(glad_glMapBufferRange, s_MapBufferRange, &mapBufferRange);
+    wrap(glad_glTexImage2D, s_TexImage2D, &texImage2D);
+    wrap(glad_glTexImage3D, s_TexImage3D, &texImage3D);
+    wrap(glad_glTexSubImage3D, s_TexSubImage3D, &texSubImage3D);
+    wrap(glad_glCompressedTexImage2D, s_CompressedTexImage2D, &compressedTexImage2D);
+    wrap(glad_glCompressedTexImage3D, s_CompressedTexImage3D, &compressedTexImage3D);
+    wrap(glad_glCompressedTexSubImage3D, s_CompressedTexSubImage3D, &compressedTexSubImage3D);
+}
+
+bool GLStats::installed()
+{
+    return s_Installed;
+}
+
+const GLCounters& GLStats::counters()
+{
+    return s_Counters;
+}
+
+void GLStats::endFrame()
+{
+    s_LastFrame = s_Frame;
+    for (int i = 0; i < (int)GLCall::Count; i++)
+    {
+        s_Total.kinds[i].calls += s_Frame.kinds[i].calls;
+        s_Total.kinds[i].redundant += s_Frame.kinds[i].redundant;
+        s_Total.kinds[i].bytes += s_Frame.kinds[i].bytes;
+    }
+    s_Frames++;
+    s_Frame = GLFrameCalls();
+}
+
+const GLFrameCalls& GLStats::lastFrame()
+{
+    return s_LastFrame;
+}
+
+const char* GLStats::name(GLCall call)
+{
+    switch (call)
+    {
+    case GLCall::UseProgram: return "UseProgram";
+    case GLCall::BindVertexArray: return "BindVertexArray";
+    case GLCall::BindBuffer: return "BindBuffer";
+    case GLCall::ActiveTexture: return "ActiveTexture";
+    case GLCall::BindTexture: return "BindTexture";
+    case GLCall::TexParameter: return "TexParameteri";
+    case GLCall::Uniform: return "Uniform*";
+    case GLCall::Draw: return "Draw*";
+    case GLCall::BufferData: return "Buffer*Data";
+    default: return "?";
+    }
+}
+
+std::vector<std::string> GLStats::frameLines()
+{
+    std::vector<std::string> lines;
+    char line[96];
+    snprintf(line, sizeof(line), "%-16s %7s %9s %10s", "gl last frame", "calls", "redundant", "bytes");
+    lines.push_back(line);
+    for (int i = 0; i < (int)GLCall::Count; i++)
+    {
+        const GLCallCount& counted = s_LastFrame.kinds[i];
+        snprintf(line, sizeof(line), "%-16s %7llu %9llu %10llu", name((GLCall)i), (unsigned long long)counted.calls,
+            (unsigned long long)counted.redundant, (unsigned long long)counted.bytes);
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+void GLStats::printAverages()
+{
+    if (s_Frames == 0)
+        return;
+    std::cout << "GLStats: per frame over " << s_Frames << " frames" << std::endl;
+    char line[96];
+    snprintf(line, sizeof(line), "%-16s %10s %10s %12s", "call", "calls", "redundant", "bytes");
+    std::cout << line << std::endl;
+    double frames = (double)s_Frames;
+    for (int i = 0; i < (int)GLCall::Count; i++)
+    {
+        const GLCallCount& counted = s_Total.kinds[i];
+        snprintf(line, sizeof(line), "%-16s %10.2f %10.2f %12.1f", name((GLCall)i), counted.calls / frames,
+            counted.redundant / frames, counted.bytes / frames);
+        std::cout << line << std::endl;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// running totals since install()
+struct GLCounters
+{
+    uint64_t drawCalls = 0;
+    // program, vertex array, texture and buffer binds, texture parameters and fixed-function state
+    uint64_t stateChanges = 0;
+    // buffer and texture data handed to GL, including writes through mapped buffers; data
+    // staged through a pixel-unpack buffer counts once, when it goes into the buffer
+    uint64_t uploadedBytes = 0;
+};
+
+// the calls broken out one kind at a time
+enum class GLCall
+{
+    UseProgram,
+    BindVertexArray,
+    BindBuffer,
+    ActiveTexture,
+    BindTexture,
+    TexParameter,
+    Uniform,
+    Draw,
+    BufferData,
+    Count
+};
+
+struct GLCallCount
+{
+    uint64_t calls = 0;
+    // binds of what was already bound, and texture parameters set to the value they had
+    uint64_t redundant = 0;
+    // uniform values, and buffer data for glBufferData/glBufferSubData
+    uint64_t bytes = 0;
+};
+
+struct GLFrameCalls
+{
+    GLCallCount kinds[(int)GLCall::Count];
+};
+
+// Counts what the app asks of GL by swapping a few of glad's function pointers for
+// wrappers that count and forward. Installed for measured runs, and for every run in a
+// -DGL_INTERCEPT=ON build; otherwise the app calls the driver directly and pays nothing.
+// The wrappers shadow the current program, vertex array, buffer and texture bindings
+// and the texture parameters set so far, so a call that changes nothing is flagged as
+// redundant. Only meaningful with a single GL context on one thread.
+class GLStats
+{
+public:
+    // after gladLoadGL*, on the GL thread
+    static void install();
+    static bool installed();
+
+    static const GLCounters& counters();
+
+    // closes the current frame's call counts; lastFrame() then returns them
+    static void endFrame();
+    static const GLFrameCalls& lastFrame();
+    static const char* name(GLCall call);
+    // a small table of lastFrame(), one line per kind, for the profiler overlay
+    static std::vector<std::string> frameLines();
+    // average calls per frame over every endFrame() so far
+    static void printAverages();
+};
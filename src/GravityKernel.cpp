@@ -0,0 +1,109 @@
+#include "GravityKernel.h"
+
+#include <cmath>
+
+#if defined(SOLAR_GRAVITY_SIMD) && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+void gravityKernelScalar(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        const double xi = x[i], yi = y[i], zi = z[i];
+        double sx = 0.0, sy = 0.0, sz = 0.0;
+        for (size_t j = 0; j < n; j++)
+        {
+            double dx = x[j] - xi;
+            double dy = y[j] - yi;
+            double dz = z[j] - zi;
+            double invR = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+            double s = mass[j] * invR * invR * invR;
+            sx += s * dx;
+            sy += s * dy;
+            sz += s * dz;
+        }
+        ax[i] = sx;
+        ay[i] = sy;
+        az[i] = sz;
+    }
+}
+
+static SimdLevel querySimdLevel()
+{
+#if defined(SOLAR_GRAVITY_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool sse42 = (info[2] & (1 << 20)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx2 = false, avx512 = false;
+    if (maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+        avx512 = (info[1] & (1 << 16)) != 0;
+    }
+    // the OS has to save the wider registers on context switches, or using them corrupts state
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    if (avx512 && (xcr0 & 0xE6) == 0xE6)
+        return SimdLevel::AVX512;
+    if (avx2 && fma && (xcr0 & 0x6) == 0x6)
+        return SimdLevel::AVX2;
+    if (sse42)
+        return SimdLevel::SSE42;
+#elif defined(SOLAR_GRAVITY_SIMD)
+    // libgcc checks XCR0 as well, so these only report what the OS has enabled
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.2"))
+        return SimdLevel::SSE42;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel detectSimdLevel()
+{
+    static const SimdLevel level = querySimdLevel();
+    return level;
+}
+
+const char* simdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE42:
+        return "SSE4.2";
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::AVX512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+GravityKernelFn gravityKernel(SimdLevel level)
+{
+#if defined(SOLAR_GRAVITY_SIMD)
+    switch (level)
+    {
+    case SimdLevel::SSE42:
+        return gravityKernelSSE42;
+    case SimdLevel::AVX2:
+        return gravityKernelAVX2;
+    case SimdLevel::AVX512:
+        return gravityKernelAVX512;
+    default:
+        break;
+    }
+#endif
+    return gravityKernelScalar;
+}
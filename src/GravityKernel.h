@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+// Direct-summation gravity: for every body i in [begin, end),
+//   a_i = sum_j m_j (r_j - r_i) / (|r_j - r_i|^2 + eps2)^(3/2)
+// over all n structure-of-arrays doubles. Only a[begin, end) is written, so
+// disjoint ranges can run on different threads. eps2 must be at least FLT_MIN, which
+// also makes the j == i term vanish: the SIMD versions take their reciprocal square root
+// estimate in single precision, where a smaller r2 becomes 0 and the result NaN. They
+// refine it by Newton steps in double until each interaction is within a few ulp of the
+// scalar one; the sums then differ only by summation order, about 1e-14 relative at
+// N = 2000 (nbody_bench reports the maximum).
+typedef void (*GravityKernelFn)(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az);
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE42,  // 2 doubles per lane
+    AVX2,   // 4 doubles per lane, with FMA
+    AVX512  // 8 doubles per lane
+};
+
+// the widest level this CPU and OS support
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// the kernel for `level`, which must not exceed detectSimdLevel()
+GravityKernelFn gravityKernel(SimdLevel level);
+
+// one translation unit per instruction set, each compiled with its own target flags
+void gravityKernelScalar(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az);
+void gravityKernelSSE42(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az);
+void gravityKernelAVX2(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az);
+void gravityKernelAVX512(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az);
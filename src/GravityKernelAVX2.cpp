@@ -0,0 +1,69 @@
+// compiled with -mavx2 -mfma; only called when detectSimdLevel() allows it
+#include "GravityKernel.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+static inline double horizontalSum(__m256d v)
+{
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_pd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+void gravityKernelAVX2(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az)
+{
+    const __m256d soft = _mm256_set1_pd(eps2);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d threeHalves = _mm256_set1_pd(1.5);
+    const size_t body = n & ~(size_t)3;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const __m256d xi = _mm256_set1_pd(x[i]);
+        const __m256d yi = _mm256_set1_pd(y[i]);
+        const __m256d zi = _mm256_set1_pd(z[i]);
+        __m256d sx = _mm256_setzero_pd();
+        __m256d sy = _mm256_setzero_pd();
+        __m256d sz = _mm256_setzero_pd();
+
+        for (size_t j = 0; j < body; j += 4)
+        {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + j), xi);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + j), yi);
+            __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + j), zi);
+            __m256d r2 = _mm256_fmadd_pd(dx, dx, _mm256_fmadd_pd(dy, dy, _mm256_fmadd_pd(dz, dz, soft)));
+
+            // ~12-bit estimate, then three Newton steps: y' = y (3/2 - r2/2 y^2); each doubles
+            // the bits, and two would leave ~46, which cubing invR below makes ~300 ulp
+            __m256d invR = _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(r2)));
+            __m256d halfR2 = _mm256_mul_pd(half, r2);
+            invR = _mm256_mul_pd(invR, _mm256_fnmadd_pd(halfR2, _mm256_mul_pd(invR, invR), threeHalves));
+            invR = _mm256_mul_pd(invR, _mm256_fnmadd_pd(halfR2, _mm256_mul_pd(invR, invR), threeHalves));
+            invR = _mm256_mul_pd(invR, _mm256_fnmadd_pd(halfR2, _mm256_mul_pd(invR, invR), threeHalves));
+
+            __m256d s = _mm256_mul_pd(_mm256_loadu_pd(mass + j), _mm256_mul_pd(invR, _mm256_mul_pd(invR, invR)));
+            sx = _mm256_fmadd_pd(s, dx, sx);
+            sy = _mm256_fmadd_pd(s, dy, sy);
+            sz = _mm256_fmadd_pd(s, dz, sz);
+        }
+
+        double accX = horizontalSum(sx);
+        double accY = horizontalSum(sy);
+        double accZ = horizontalSum(sz);
+        for (size_t j = body; j < n; j++)
+        {
+            double dx = x[j] - x[i];
+            double dy = y[j] - y[i];
+            double dz = z[j] - z[i];
+            double invR = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+            double s = mass[j] * invR * invR * invR;
+            accX += s * dx;
+            accY += s * dy;
+            accZ += s * dz;
+        }
+        ax[i] = accX;
+        ay[i] = accY;
+        az[i] = accZ;
+    }
+}
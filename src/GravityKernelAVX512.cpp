@@ -0,0 +1,47 @@
+// compiled with -mavx512f; only called when detectSimdLevel() allows it
+#include "GravityKernel.h"
+
+#include <immintrin.h>
+
+void gravityKernelAVX512(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az)
+{
+    const __m512d soft = _mm512_set1_pd(eps2);
+    const __m512d half = _mm512_set1_pd(0.5);
+    const __m512d threeHalves = _mm512_set1_pd(1.5);
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const __m512d xi = _mm512_set1_pd(x[i]);
+        const __m512d yi = _mm512_set1_pd(y[i]);
+        const __m512d zi = _mm512_set1_pd(z[i]);
+        __m512d sx = _mm512_setzero_pd();
+        __m512d sy = _mm512_setzero_pd();
+        __m512d sz = _mm512_setzero_pd();
+
+        for (size_t j = 0; j < n; j += 8)
+        {
+            // the last block masks off lanes past n; their zero mass makes them contribute nothing
+            __mmask8 lanes = n - j >= 8 ? (__mmask8)0xFF : (__mmask8)((1u << (n - j)) - 1);
+            __m512d dx = _mm512_sub_pd(_mm512_maskz_loadu_pd(lanes, x + j), xi);
+            __m512d dy = _mm512_sub_pd(_mm512_maskz_loadu_pd(lanes, y + j), yi);
+            __m512d dz = _mm512_sub_pd(_mm512_maskz_loadu_pd(lanes, z + j), zi);
+            __m512d r2 = _mm512_fmadd_pd(dx, dx, _mm512_fmadd_pd(dy, dy, _mm512_fmadd_pd(dz, dz, soft)));
+
+            // 14-bit estimate, then two Newton steps: y' = y (3/2 - r2/2 y^2)
+            __m512d invR = _mm512_rsqrt14_pd(r2);
+            __m512d halfR2 = _mm512_mul_pd(half, r2);
+            invR = _mm512_mul_pd(invR, _mm512_fnmadd_pd(halfR2, _mm512_mul_pd(invR, invR), threeHalves));
+            invR = _mm512_mul_pd(invR, _mm512_fnmadd_pd(halfR2, _mm512_mul_pd(invR, invR), threeHalves));
+
+            __m512d s = _mm512_mul_pd(_mm512_maskz_loadu_pd(lanes, mass + j), _mm512_mul_pd(invR, _mm512_mul_pd(invR, invR)));
+            sx = _mm512_fmadd_pd(s, dx, sx);
+            sy = _mm512_fmadd_pd(s, dy, sy);
+            sz = _mm512_fmadd_pd(s, dz, sz);
+        }
+
+        ax[i] = _mm512_reduce_add_pd(sx);
+        ay[i] = _mm512_reduce_add_pd(sy);
+        az[i] = _mm512_reduce_add_pd(sz);
+    }
+}
@@ -0,0 +1,63 @@
+// compiled with -msse4.2; only called when detectSimdLevel() allows it
+#include "GravityKernel.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+void gravityKernelSSE42(size_t begin, size_t end, size_t n, const double* x, const double* y, const double* z, const double* mass,
+    double eps2, double* ax, double* ay, double* az)
+{
+    const __m128d soft = _mm_set1_pd(eps2);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d threeHalves = _mm_set1_pd(1.5);
+    const size_t body = n & ~(size_t)1;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const __m128d xi = _mm_set1_pd(x[i]);
+        const __m128d yi = _mm_set1_pd(y[i]);
+        const __m128d zi = _mm_set1_pd(z[i]);
+        __m128d sx = _mm_setzero_pd();
+        __m128d sy = _mm_setzero_pd();
+        __m128d sz = _mm_setzero_pd();
+
+        for (size_t j = 0; j < body; j += 2)
+        {
+            __m128d dx = _mm_sub_pd(_mm_loadu_pd(x + j), xi);
+            __m128d dy = _mm_sub_pd(_mm_loadu_pd(y + j), yi);
+            __m128d dz = _mm_sub_pd(_mm_loadu_pd(z + j), zi);
+            __m128d r2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_add_pd(_mm_mul_pd(dz, dz), soft));
+
+            // ~12-bit estimate, then three Newton steps: y' = y (3/2 - r2/2 y^2); each doubles
+            // the bits, and two would leave ~46, which cubing invR below makes ~300 ulp
+            __m128d invR = _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(r2)));
+            __m128d halfR2 = _mm_mul_pd(half, r2);
+            invR = _mm_mul_pd(invR, _mm_sub_pd(threeHalves, _mm_mul_pd(halfR2, _mm_mul_pd(invR, invR))));
+            invR = _mm_mul_pd(invR, _mm_sub_pd(threeHalves, _mm_mul_pd(halfR2, _mm_mul_pd(invR, invR))));
+            invR = _mm_mul_pd(invR, _mm_sub_pd(threeHalves, _mm_mul_pd(halfR2, _mm_mul_pd(invR, invR))));
+
+            __m128d s = _mm_mul_pd(_mm_loadu_pd(mass + j), _mm_mul_pd(invR, _mm_mul_pd(invR, invR)));
+            sx = _mm_add_pd(sx, _mm_mul_pd(s, dx));
+            sy = _mm_add_pd(sy, _mm_mul_pd(s, dy));
+            sz = _mm_add_pd(sz, _mm_mul_pd(s, dz));
+        }
+
+        double accX = _mm_cvtsd_f64(_mm_add_pd(sx, _mm_unpackhi_pd(sx, sx)));
+        double accY = _mm_cvtsd_f64(_mm_add_pd(sy, _mm_unpackhi_pd(sy, sy)));
+        double accZ = _mm_cvtsd_f64(_mm_add_pd(sz, _mm_unpackhi_pd(sz, sz)));
+        for (size_t j = body; j < n; j++)
+        {
+            double dx = x[j] - x[i];
+            double dy = y[j] - y[i];
+            double dz = z[j] - z[i];
+            double invR = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+            double s = mass[j] * invR * invR * invR;
+            accX += s * dx;
+            accY += s * dy;
+            accZ += s * dz;
+        }
+        ax[i] = accX;
+        ay[i] = accY;
+        az[i] = accZ;
+    }
+}
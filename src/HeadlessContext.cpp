@@ -0,0 +1,136 @@
+#include "HeadlessContext.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <iostream>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+HeadlessContext::HeadlessContext()
+    : m_Display(EGL_NO_DISPLAY), m_Surface(EGL_NO_SURFACE), m_Context(EGL_NO_CONTEXT),
+      m_Width(0), m_Height(0), m_FBO(0), m_ColorBuffer(0), m_DepthBuffer(0)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+bool HeadlessContext::create(int width, int height)
+{
+    // prefer the surfaceless platform: it needs neither an X server nor a GPU device
+    EGLDisplay display = EGL_NO_DISPLAY;
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        std::cout << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    m_Display = display;
+
+    // the surface type defaults to windows, which a surfaceless display has none of
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs == 0 || !eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "No EGL config with desktop OpenGL" << std::endl;
+        destroy();
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    m_Context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (m_Context == EGL_NO_CONTEXT)
+    {
+        std::cout << "Failed to create a GL 3.3 core EGL context" << std::endl;
+        destroy();
+        return false;
+    }
+
+    // drivers without EGL_KHR_surfaceless_context still need some surface to be current
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context))
+    {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+        m_Surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (m_Surface == EGL_NO_SURFACE || !eglMakeCurrent(display, m_Surface, m_Surface, m_Context))
+        {
+            std::cout << "Failed to make the EGL context current" << std::endl;
+            destroy();
+            return false;
+        }
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        destroy();
+        return false;
+    }
+
+    m_Width = width;
+    m_Height = height;
+
+    glGenRenderbuffers(1, &m_ColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_ColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &m_DepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_DepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+        destroy();
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    return true;
+}
+
+void HeadlessContext::destroy()
+{
+    if (m_Context != EGL_NO_CONTEXT && m_FBO)
+    {
+        glDeleteFramebuffers(1, &m_FBO);
+        glDeleteRenderbuffers(1, &m_ColorBuffer);
+        glDeleteRenderbuffers(1, &m_DepthBuffer);
+        m_FBO = m_ColorBuffer = m_DepthBuffer = 0;
+    }
+    if (m_Display != EGL_NO_DISPLAY)
+    {
+        eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_Context != EGL_NO_CONTEXT)
+            eglDestroyContext(m_Display, m_Context);
+        if (m_Surface != EGL_NO_SURFACE)
+            eglDestroySurface(m_Display, m_Surface);
+        eglTerminate(m_Display);
+    }
+    m_Display = EGL_NO_DISPLAY;
+    m_Surface = EGL_NO_SURFACE;
+    m_Context = EGL_NO_CONTEXT;
+}
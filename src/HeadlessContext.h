@@ -0,0 +1,34 @@
+#pragma once
+
+#include "glad/glad.h"
+
+// GL 3.3 core context with no window, for `main --headless`.
+// Uses an EGL surfaceless display (Mesa llvmpipe works on machines without a GPU),
+// falling back to a pbuffer, and renders into an offscreen framebuffer of the
+// requested size that stays bound for the whole run. Only built with -DHEADLESS=ON.
+class HeadlessContext
+{
+private:
+    void* m_Display;
+    void* m_Surface;
+    void* m_Context;
+    int m_Width;
+    int m_Height;
+    unsigned int m_FBO;
+    unsigned int m_ColorBuffer;
+    unsigned int m_DepthBuffer;
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    // creates the context, loads GL through glad and binds the framebuffer; prints why on failure
+    bool create(int width, int height);
+    void destroy();
+
+    int width() const { return m_Width; }
+    int height() const { return m_Height; }
+};
@@ -0,0 +1,264 @@
+#include "JobSystem.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+    // which JobSystem, if any, the current thread is a worker of
+    thread_local const JobSystem* t_System = nullptr;
+    thread_local int t_Worker = -1;
+}
+
+bool JobSystem::WorkDeque::push(Job* job)
+{
+    int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+    int64_t top = m_Top.load(std::memory_order_acquire);
+    if (bottom - top >= Capacity)
+        return false;
+
+    m_Items[bottom & (Capacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+JobSystem::Job* JobSystem::WorkDeque::pop()
+{
+    int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    m_Bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_Top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_Items[bottom & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // the last job: race the thieves for it
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+JobSystem::Job* JobSystem::WorkDeque::steal()
+{
+    int64_t top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+
+    Job* job = m_Items[top & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+JobSystem::JobSystem(unsigned int numThreads)
+{
+    if (numThreads == 0)
+        numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    for (unsigned int i = 0; i < numThreads; i++)
+        m_Deques.emplace_back(new WorkDeque());
+    for (unsigned int i = 0; i < numThreads; i++)
+        m_Workers.emplace_back(&JobSystem::workerLoop, this, (int)i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Stopping = true;
+    }
+    m_SleepCond.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+
+    // anything still queued was never waited for
+    for (Job* job : m_Injected)
+        delete job;
+    for (auto& deque : m_Deques)
+    {
+        while (Job* job = deque->steal())
+            delete job;
+    }
+}
+
+JobSystem& JobSystem::global()
+{
+    static JobSystem jobs;
+    return jobs;
+}
+
+int JobSystem::workerIndex() const
+{
+    return t_System == this ? t_Worker : -1;
+}
+
+void JobSystem::run(JobFn fn, Counter* counter)
+{
+    if (counter)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    Job* job = new Job{ std::move(fn), counter };
+
+    int worker = workerIndex();
+    if (worker < 0 || !m_Deques[worker]->push(job))
+    {
+        std::lock_guard<std::mutex> lock(m_InjectMutex);
+        m_Injected.push_back(job);
+    }
+
+    // pairs with the sleeper incrementing m_Sleeping before it checks m_Queued
+    m_Queued.fetch_add(1, std::memory_order_seq_cst);
+    if (m_Sleeping.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_SleepCond.notify_one();
+    }
+}
+
+JobSystem::Job* JobSystem::findJob(int worker)
+{
+    Job* job = nullptr;
+    if (worker >= 0)
+        job = m_Deques[worker]->pop();
+
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(m_InjectMutex);
+        if (!m_Injected.empty())
+        {
+            job = m_Injected.front();
+            m_Injected.pop_front();
+        }
+    }
+
+    // start at a different victim on each worker so thieves do not all hit the same deque
+    const size_t count = m_Deques.size();
+    for (size_t i = 0; !job && i < count; i++)
+    {
+        size_t victim = ((size_t)(worker + 1) + i) % count;
+        if ((int)victim != worker)
+            job = m_Deques[victim]->steal();
+    }
+
+    if (job)
+        m_Queued.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::execute(Job* job)
+{
+    {
+        TraceScope trace("job");
+        job->fn();
+    }
+    if (job->counter)
+        job->counter->pending.fetch_sub(1, std::memory_order_release);
+    delete job;
+}
+
+void JobSystem::wait(Counter& counter)
+{
+    int worker = workerIndex();
+    while (!counter.done())
+    {
+        if (Job* job = findJob(worker))
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn)
+{
+    grain = std::max<size_t>(1, grain);
+    if (count <= grain)
+    {
+        if (count)
+            fn(0, count);
+        return;
+    }
+
+    // the caller takes the first chunk itself
+    Counter counter;
+    for (size_t begin = grain; begin < count; begin += grain)
+    {
+        size_t end = std::min(count, begin + grain);
+        run([&fn, begin, end]() { fn(begin, end); }, &counter);
+    }
+    fn(0, grain);
+    wait(counter);
+}
+
+void JobSystem::workerLoop(int worker)
+{
+    t_System = this;
+    t_Worker = worker;
+    Trace::setThreadName("job worker " + std::to_string(worker), Trace::WorkerCapacity);
+
+    while (!m_Stopping.load(std::memory_order_relaxed))
+    {
+        if (Job* job = findJob(worker))
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+        m_SleepCond.wait(lock, [this] { return m_Stopping.load() || m_Queued.load(std::memory_order_seq_cst) > 0; });
+        m_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+TaskGraph::Task TaskGraph::add(JobSystem::JobFn fn)
+{
+    m_Nodes.emplace_back();
+    m_Nodes.back().fn = std::move(fn);
+    return m_Nodes.size() - 1;
+}
+
+void TaskGraph::precede(Task before, Task after)
+{
+    m_Nodes[before].successors.push_back(after);
+    m_Nodes[after].dependencies++;
+}
+
+void TaskGraph::schedule(JobSystem& jobs, JobSystem::Counter& counter, Task task)
+{
+    // successors are queued before this task counts as finished, so the counter cannot reach zero early
+    jobs.run([this, &jobs, &counter, task]() {
+        Node& node = m_Nodes[task];
+        node.fn();
+        for (Task successor : node.successors)
+        {
+            if (m_Nodes[successor].remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                schedule(jobs, counter, successor);
+        }
+    }, &counter);
+}
+
+void TaskGraph::run(JobSystem& jobs)
+{
+    for (Node& node : m_Nodes)
+        node.remaining.store(node.dependencies, std::memory_order_relaxed);
+
+    JobSystem::Counter counter;
+    for (Task task = 0; task < m_Nodes.size(); task++)
+    {
+        if (m_Nodes[task].dependencies == 0)
+            schedule(jobs, counter, task);
+    }
+    jobs.wait(counter);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing scheduler shared by the whole app: simulation, tree builds,
+// mesh generation, per-body transforms and texture decoding all run on it.
+// Every worker owns a Chase-Lev deque; it pushes and pops jobs at the bottom, and
+// idle workers steal from the top of the others'. Threads that are not workers
+// (the GL thread, the simulation thread) queue into a shared injection queue,
+// and anyone waiting on a Counter runs jobs until it drops to zero, so waiting
+// never idles a core. Jobs must not touch GL: any thread may end up running them.
+class JobSystem
+{
+public:
+    typedef std::function<void()> JobFn;
+
+    // jobs that were started with this counter and have not finished yet
+    struct Counter
+    {
+        std::atomic<int> pending{ 0 };
+        bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    // 0 threads: one per core besides the caller's, and at least one
+    explicit JobSystem(unsigned int numThreads = 0);
+    ~JobSystem();
+
+    // created on first use
+    static JobSystem& global();
+
+    unsigned int workerCount() const { return (unsigned int)m_Workers.size(); }
+
+    void run(JobFn fn, Counter* counter = nullptr);
+    // runs queued jobs on the calling thread until counter is done
+    void wait(Counter& counter);
+
+    // fn(begin, end) over [0, count) in chunks of at most grain, one job each; a single
+    // chunk runs inline. Returns once every chunk has run
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+private:
+    struct Job
+    {
+        JobFn fn;
+        Counter* counter;
+    };
+
+    // Chase-Lev deque with a fixed capacity (Le et al. 2013, "Correct and efficient
+    // work-stealing for weak memory models"); push() fails once it is full
+    class WorkDeque
+    {
+    public:
+        static const int64_t Capacity = 4096;
+
+        bool push(Job* job);
+        Job* pop();
+        Job* steal();
+
+    private:
+        std::atomic<int64_t> m_Top{ 0 };
+        std::atomic<int64_t> m_Bottom{ 0 };
+        std::atomic<Job*> m_Items[Capacity];
+    };
+
+    std::vector<std::unique_ptr<WorkDeque>> m_Deques;
+    std::vector<std::thread> m_Workers;
+
+    // jobs from threads that have no deque
+    std::mutex m_InjectMutex;
+    std::deque<Job*> m_Injected;
+
+    // idle workers sleep until something is queued
+    std::atomic<int> m_Queued{ 0 };
+    std::atomic<int> m_Sleeping{ 0 };
+    std::atomic<bool> m_Stopping{ false };
+    std::mutex m_SleepMutex;
+    std::condition_variable m_SleepCond;
+
+    int workerIndex() const;
+    Job* findJob(int worker);
+    void execute(Job* job);
+    void workerLoop(int worker);
+};
+
+// Jobs with dependencies: each task is queued once every task it comes after has
+// finished, and run() returns when the whole graph has.
+class TaskGraph
+{
+public:
+    typedef size_t Task;
+
+    Task add(JobSystem::JobFn fn);
+    // `after` waits for `before`
+    void precede(Task before, Task after);
+
+    // the graph can be run again once this returns
+    void run(JobSystem& jobs);
+
+private:
+    struct Node
+    {
+        JobSystem::JobFn fn;
+        std::vector<Task> successors;
+        int dependencies = 0;
+        std::atomic<int> remaining{ 0 };
+    };
+
+    std::deque<Node> m_Nodes;
+
+    void schedule(JobSystem& jobs, JobSystem::Counter& counter, Task task);
+};
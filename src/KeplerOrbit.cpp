@@ -0,0 +1,216 @@
+#include "KeplerOrbit.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const double Pi = 3.14159265358979323846;
+    const double HalfPi = 0.5 * Pi;
+    const double TwoPi = 2.0 * Pi;
+
+    // lanes per batch; 8 doubles fill an AVX-512 register or two AVX2 ones
+    const size_t Lanes = 8;
+    const int MaxIterations = 32;
+    // |E - e sin E - M| below this before the last Newton step leaves E exact to rounding
+    const double Tolerance = 1e-12;
+
+    // M wrapped into [-pi, pi)
+    double wrapAngle(double m)
+    {
+        return m - TwoPi * std::floor((m + Pi) / TwoPi);
+    }
+
+    // Danby's starter, pulled back into [0, pi] where the root of a wrapped, non-negative M lies
+    double starter(double m, double e)
+    {
+        return std::min(m + 0.85 * e, Pi);
+    }
+
+    // sin and cos of x in [0, pi] from Taylor series about pi/2, branch-free so
+    // lane loops vectorize; the truncation error is below 2e-17 over the range
+    inline void sinCos(double x, double& s, double& c)
+    {
+        double t = x - HalfPi;
+        double t2 = t * t;
+        // sin x = cos t
+        double ct = 1.0 / 1124000727777607680000.0;
+        ct = ct * t2 - 1.0 / 2432902008176640000.0;
+        ct = ct * t2 + 1.0 / 6402373705728000.0;
+        ct = ct * t2 - 1.0 / 20922789888000.0;
+        ct = ct * t2 + 1.0 / 87178291200.0;
+        ct = ct * t2 - 1.0 / 479001600.0;
+        ct = ct * t2 + 1.0 / 3628800.0;
+        ct = ct * t2 - 1.0 / 40320.0;
+        ct = ct * t2 + 1.0 / 720.0;
+        ct = ct * t2 - 1.0 / 24.0;
+        ct = ct * t2 + 0.5;
+        ct = 1.0 - ct * t2;
+        // cos x = -sin t
+        double st = -1.0 / 51090942171709440000.0;
+        st = st * t2 + 1.0 / 121645100408832000.0;
+        st = st * t2 - 1.0 / 355687428096000.0;
+        st = st * t2 + 1.0 / 1307674368000.0;
+        st = st * t2 - 1.0 / 6227020800.0;
+        st = st * t2 + 1.0 / 39916800.0;
+        st = st * t2 - 1.0 / 362880.0;
+        st = st * t2 + 1.0 / 5040.0;
+        st = st * t2 - 1.0 / 120.0;
+        st = st * t2 + 1.0 / 6.0;
+        st = t - st * t2 * t;
+        s = ct;
+        c = -st;
+    }
+}
+
+double solveKepler(double meanAnomaly, double eccentricity)
+{
+    // the equation is odd in E and M, so solve for |M| in [0, pi] and restore the sign
+    double wrapped = wrapAngle(meanAnomaly);
+    double sign = wrapped < 0.0 ? -1.0 : 1.0;
+    double m = std::fabs(wrapped);
+
+    double e = starter(m, eccentricity);
+    for (int iteration = 0; iteration < MaxIterations; iteration++)
+    {
+        double f = e - eccentricity * std::sin(e) - m;
+        e -= f / (1.0 - eccentricity * std::cos(e));
+        if (std::fabs(f) < Tolerance)
+            break;
+    }
+    return sign * e + (meanAnomaly - wrapped);
+}
+
+double KeplerOrbit::meanMotion(double gm) const
+{
+    return std::sqrt(gm / (semiMajorAxis * semiMajorAxis * semiMajorAxis));
+}
+
+void KeplerOrbit::axes(glm::dvec3& p, glm::dvec3& q) const
+{
+    double cosNode = std::cos(ascendingNode), sinNode = std::sin(ascendingNode);
+    double cosPeri = std::cos(argumentOfPeriapsis), sinPeri = std::sin(argumentOfPeriapsis);
+    double cosIncl = std::cos(inclination), sinIncl = std::sin(inclination);
+
+    // the usual perifocal-to-reference rotation, with the reference plane's second axis along scene +Z
+    // and its pole along scene +Y
+    glm::dvec3 toPeriapsis(cosNode * cosPeri - sinNode * sinPeri * cosIncl, sinPeri * sinIncl,
+        sinNode * cosPeri + cosNode * sinPeri * cosIncl);
+    glm::dvec3 ahead(-cosNode * sinPeri - sinNode * cosPeri * cosIncl, cosPeri * sinIncl,
+        -sinNode * sinPeri + cosNode * cosPeri * cosIncl);
+
+    double semiMinorAxis = semiMajorAxis * std::sqrt(1.0 - eccentricity * eccentricity);
+    p = semiMajorAxis * toPeriapsis;
+    q = semiMinorAxis * ahead;
+}
+
+glm::dvec3 KeplerOrbit::position(double gm, double time) const
+{
+    glm::dvec3 p, q;
+    axes(p, q);
+    double anomaly = solveKepler(meanAnomaly + meanMotion(gm) * time, eccentricity);
+    return (std::cos(anomaly) - eccentricity) * p + std::sin(anomaly) * q;
+}
+
+void KeplerOrbit::state(double gm, double time, glm::dvec3& position, glm::dvec3& velocity) const
+{
+    glm::dvec3 p, q;
+    axes(p, q);
+    double n = meanMotion(gm);
+    double anomaly = solveKepler(meanAnomaly + n * time, eccentricity);
+    double cosE = std::cos(anomaly), sinE = std::sin(anomaly);
+
+    // dE/dt = n / (1 - e cos E)
+    double rate = n / (1.0 - eccentricity * cosE);
+    position = (cosE - eccentricity) * p + sinE * q;
+    velocity = rate * (-sinE * p + cosE * q);
+}
+
+glm::dmat4 KeplerOrbit::ellipse() const
+{
+    glm::dvec3 p, q;
+    axes(p, q);
+    // (sin t, 0, cos t) lands on p sin t + q cos t about the ellipse's centre, which is a e behind the focus
+    return glm::dmat4(glm::dvec4(p, 0.0), glm::dvec4(glm::normalize(glm::cross(q, p)), 0.0), glm::dvec4(q, 0.0),
+        glm::dvec4(-eccentricity * p, 1.0));
+}
+
+void KeplerOrbitSet::add(const KeplerOrbit& orbit, double gm)
+{
+    glm::dvec3 p, q;
+    orbit.axes(p, q);
+    m_MeanMotion.push_back(orbit.meanMotion(gm));
+    m_MeanAnomaly.push_back(orbit.meanAnomaly);
+    m_Eccentricity.push_back(orbit.eccentricity);
+    m_PX.push_back(p.x);
+    m_PY.push_back(p.y);
+    m_PZ.push_back(p.z);
+    m_QX.push_back(q.x);
+    m_QY.push_back(q.y);
+    m_QZ.push_back(q.z);
+}
+
+void KeplerOrbitSet::clear()
+{
+    m_MeanMotion.clear();
+    m_MeanAnomaly.clear();
+    m_Eccentricity.clear();
+    m_PX.clear();
+    m_PY.clear();
+    m_PZ.clear();
+    m_QX.clear();
+    m_QY.clear();
+    m_QZ.clear();
+}
+
+void KeplerOrbitSet::positions(double time, double* x, double* y, double* z) const
+{
+    const size_t n = size();
+    for (size_t base = 0; base < n; base += Lanes)
+    {
+        const size_t count = std::min(Lanes, n - base);
+
+        // lanes past the end solve M = 0, e = 0, which converges immediately
+        double m[Lanes] = {}, ecc[Lanes] = {}, sign[Lanes], anomaly[Lanes];
+        for (size_t l = 0; l < count; l++)
+        {
+            m[l] = m_MeanAnomaly[base + l] + m_MeanMotion[base + l] * time;
+            ecc[l] = m_Eccentricity[base + l];
+        }
+        for (size_t l = 0; l < Lanes; l++)
+        {
+            double wrapped = wrapAngle(m[l]);
+            sign[l] = wrapped < 0.0 ? -1.0 : 1.0;
+            m[l] = std::fabs(wrapped);
+            anomaly[l] = starter(m[l], ecc[l]);
+        }
+
+        // Newton in lockstep; f is convex on [0, pi], so clamping keeps every iterate in range
+        for (int iteration = 0; iteration < MaxIterations; iteration++)
+        {
+            double residual[Lanes];
+            for (size_t l = 0; l < Lanes; l++)
+            {
+                double s, c;
+                sinCos(anomaly[l], s, c);
+                double f = anomaly[l] - ecc[l] * s - m[l];
+                anomaly[l] = std::min(std::max(anomaly[l] - f / (1.0 - ecc[l] * c), 0.0), Pi);
+                residual[l] = std::fabs(f);
+            }
+            if (*std::max_element(residual, residual + Lanes) < Tolerance)
+                break;
+        }
+
+        for (size_t l = 0; l < count; l++)
+        {
+            double s, c;
+            sinCos(anomaly[l], s, c);
+            s *= sign[l];
+            double along = c - ecc[l];
+            size_t i = base + l;
+            x[i] = along * m_PX[i] + s * m_QX[i];
+            y[i] = along * m_PY[i] + s * m_QY[i];
+            z[i] = along * m_PZ[i] + s * m_QZ[i];
+        }
+    }
+}
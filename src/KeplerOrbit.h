@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// Closed elliptic orbit around a point mass, evaluated analytically: the position
+// at any time is one Kepler-equation solve away, with no stepping in between.
+// Angles are in radians. The reference plane is the scene's XZ plane with +Y as
+// north; the ascending node is measured from +X toward +Z, which is also the
+// direction of motion of a prograde orbit.
+struct KeplerOrbit
+{
+    double semiMajorAxis = 1.0;
+    double eccentricity = 0.0;        // 0 <= e < 1
+    double inclination = 0.0;
+    double ascendingNode = 0.0;       // longitude of the ascending node
+    double argumentOfPeriapsis = 0.0;
+    double meanAnomaly = 0.0;         // at time 0
+
+    // gm is G times the mass being orbited (plus the orbiter's own, for a two-body orbit)
+    double meanMotion(double gm) const;
+    glm::dvec3 position(double gm, double time) const;
+    void state(double gm, double time, glm::dvec3& position, glm::dvec3& velocity) const;
+
+    // maps the unit circle in the XZ plane onto this orbit's ellipse
+    glm::dmat4 ellipse() const;
+
+    // the ellipse's axes: p towards periapsis scaled by a, q a quarter orbit on scaled by b
+    void axes(glm::dvec3& p, glm::dvec3& q) const;
+};
+
+// eccentric anomaly E with E - e sin E = M, for any M
+double solveKepler(double meanAnomaly, double eccentricity);
+
+// Many orbits around the same kind of centre, kept structure-of-arrays so their
+// positions can be evaluated in batches of lanes: the Kepler solve for a whole
+// batch runs in lockstep on branch-free polynomial sines, which the compiler turns
+// into SIMD code, and stops once every lane has converged.
+class KeplerOrbitSet
+{
+public:
+    void add(const KeplerOrbit& orbit, double gm);
+    size_t size() const { return m_MeanMotion.size(); }
+    void clear();
+
+    // positions of every orbit at `time`, relative to the body it orbits
+    void positions(double time, double* x, double* y, double* z) const;
+
+private:
+    std::vector<double> m_MeanMotion, m_MeanAnomaly, m_Eccentricity;
+    std::vector<double> m_PX, m_PY, m_PZ, m_QX, m_QY, m_QZ;
+};
@@ -0,0 +1,172 @@
+#include "PerfReport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // llvmpipe frame times move with machine load, GL counts only when the renderer changes;
+    // frame time rows are informational, their tolerance only marks a run as slower
+    const double FrameTimeTolerance = 0.30;
+    const double TailTolerance = 0.50;
+    const double CountTolerance = 0.02;
+    const double MemoryTolerance = 0.15;
+}
+
+void PerfReport::beginFrame()
+{
+    const GLCounters& counters = GLStats::counters();
+    if (!m_Started)
+    {
+        m_Startup = counters;
+        m_Started = true;
+    }
+    m_FrameBegin = counters;
+    m_FrameStart = std::chrono::steady_clock::now();
+}
+
+void PerfReport::endFrame()
+{
+    m_FrameMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_FrameStart).count());
+
+    const GLCounters& counters = GLStats::counters();
+    m_Frames.drawCalls += counters.drawCalls - m_FrameBegin.drawCalls;
+    m_Frames.stateChanges += counters.stateChanges - m_FrameBegin.stateChanges;
+    m_Frames.uploadedBytes += counters.uploadedBytes - m_FrameBegin.uploadedBytes;
+}
+
+double PerfReport::percentile(double p) const
+{
+    if (m_FrameMs.empty())
+        return 0.0;
+    std::vector<double> sorted = m_FrameMs;
+    std::sort(sorted.begin(), sorted.end());
+    // nearest rank
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+}
+
+double PerfReport::peakResidentMB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0.0;
+    return (double)counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+#ifdef __APPLE__
+    return (double)usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return (double)usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+std::vector<PerfReport::Metric> PerfReport::metrics() const
+{
+    double frames = (double)std::max<size_t>(m_FrameMs.size(), 1);
+    std::vector<Metric> metrics = {
+        { "frames", (double)m_FrameMs.size(), 0.0 },
+        { "frame_ms_p50", percentile(50.0), FrameTimeTolerance, false },
+        { "frame_ms_p95", percentile(95.0), TailTolerance, false },
+        { "frame_ms_p99", percentile(99.0), TailTolerance, false },
+        { "draw_calls_per_frame", (double)m_Frames.drawCalls / frames, CountTolerance },
+        { "state_changes_per_frame", (double)m_Frames.stateChanges / frames, CountTolerance },
+        { "uploaded_bytes_per_frame", (double)m_Frames.uploadedBytes / frames, CountTolerance },
+        { "uploaded_bytes_startup", (double)m_Startup.uploadedBytes, CountTolerance },
+        { "peak_rss_mb", peakResidentMB(), MemoryTolerance },
+    };
+    return metrics;
+}
+
+bool PerfReport::write(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cout << "PerfReport: failed to open " << path << std::endl;
+        return false;
+    }
+    fputs("# metric value tolerance\n"
+          "# a later run regresses when a metric is more than tolerance (relative) above value;\n"
+          "# informational rows are only reported\n", file);
+    for (const Metric& metric : metrics())
+        fprintf(file, "%-26s %14.4f %6.2f%s\n", metric.name.c_str(), metric.value, metric.tolerance,
+            metric.gated ? "" : "  # informational");
+    fclose(file);
+    return true;
+}
+
+bool PerfReport::compare(const std::string& baselinePath) const
+{
+    std::ifstream file(baselinePath);
+    if (!file)
+    {
+        std::cout << "PerfReport: no baseline at " << baselinePath << std::endl;
+        return false;
+    }
+    std::map<std::string, Metric> baseline;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        Metric metric;
+        if (fields >> metric.name >> metric.value >> metric.tolerance)
+            baseline[metric.name] = metric;
+    }
+
+    bool passed = true;
+    char row[160];
+    snprintf(row, sizeof(row), "%-26s %14s %14s %9s", "metric", "baseline", "run", "change");
+    std::cout << row << std::endl;
+    for (const Metric& metric : metrics())
+    {
+        auto it = baseline.find(metric.name);
+        if (it == baseline.end())
+        {
+            std::cout << "PerfReport: " << metric.name << " is not in the baseline" << std::endl;
+            continue;
+        }
+        const Metric& expected = it->second;
+
+        // a different frame count measures a different run
+        if (metric.name == "frames")
+        {
+            if (metric.value != expected.value)
+            {
+                std::cout << "PerfReport: baseline has " << expected.value << " frames, this run " << metric.value << std::endl;
+                passed = false;
+            }
+            continue;
+        }
+
+        double change = expected.value != 0.0 ? metric.value / expected.value - 1.0 : (metric.value != 0.0 ? 1.0 : 0.0);
+        bool exceeded = metric.value > expected.value * (1.0 + expected.tolerance) + 1e-9;
+        bool regressed = exceeded && metric.gated;
+        passed = passed && !regressed;
+
+        const char* verdict = !exceeded ? "" : (regressed ? "  REGRESSED" : "  slower (informational)");
+        snprintf(row, sizeof(row), "%-26s %14.3f %14.3f %+8.1f%%%s", metric.name.c_str(), expected.value, metric.value,
+            change * 100.0, verdict);
+        std::cout << row << std::endl;
+    }
+    std::cout << "PerfReport: " << (passed ? "no regressions" : "regressed") << " against " << baselinePath << std::endl;
+    return passed;
+}
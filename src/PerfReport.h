@@ -0,0 +1,48 @@
+#pragma once
+
+#include "GLStats.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// What one scripted headless run cost: frame time percentiles, GL work per frame from
+// GLStats, what was uploaded before the first frame, and peak resident memory.
+// Reports are text, one `metric value tolerance` per line, so a report can be checked
+// in as the baseline later runs are compared against. A metric regresses when it is
+// more than `tolerance` (relative, taken from the baseline) above the baseline value.
+// Frame times are informational: they depend on the machine the baseline was recorded
+// on, so they are reported against it but only GL work, uploads and memory fail a run.
+class PerfReport
+{
+public:
+    struct Metric
+    {
+        std::string name;
+        double value;
+        double tolerance;
+        // false for rows that are reported but never fail compare()
+        bool gated = true;
+    };
+
+    // GLStats must already be installed; the first beginFrame() ends the startup phase
+    void beginFrame();
+    // after the frame's GL work has finished
+    void endFrame();
+
+    std::vector<Metric> metrics() const;
+    bool write(const std::string& path) const;
+    // prints every metric against the baseline; false if any regressed or the baseline is unusable
+    bool compare(const std::string& baselinePath) const;
+
+private:
+    std::vector<double> m_FrameMs;
+    std::chrono::steady_clock::time_point m_FrameStart;
+    bool m_Started = false;
+    GLCounters m_Startup;
+    GLCounters m_FrameBegin;
+    GLCounters m_Frames;
+
+    double percentile(double p) const;
+    static double peakResidentMB();
+};
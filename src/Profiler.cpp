@@ -0,0 +1,413 @@
+#include "Profiler.h"
+
+#include "Trace.h"
+
+#include "STB/stb_easy_font.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+
+namespace
+{
+    const double Missing = std::numeric_limits<double>::quiet_NaN();
+
+    // graph geometry in pixels: one column per frame of history, MaxMs at the top
+    const float Margin = 8.0f;
+    const float Padding = 6.0f;
+    const float BarWidth = 2.0f;
+    const float GraphHeight = 120.0f;
+    const float LineHeight = 10.0f;
+    const double MaxMs = 1000.0 / 30.0;
+    const double BudgetMs = 1000.0 / 60.0;
+
+    const unsigned char Palette[][4] = {
+        {230, 90, 70, 255}, {90, 180, 240, 255}, {250, 200, 60, 255}, {120, 210, 110, 255},
+        {200, 120, 230, 255}, {240, 140, 40, 255}, {80, 220, 200, 255}, {230, 110, 170, 255},
+    };
+    const unsigned char Panel[4] = {10, 10, 16, 200};
+    const unsigned char FrameBar[4] = {70, 70, 80, 255};
+    const unsigned char Budget[4] = {255, 255, 255, 160};
+    const unsigned char Text[4] = {230, 230, 230, 255};
+
+    double milliseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    void writeValue(FILE* file, double value)
+    {
+        if (std::isnan(value))
+            fputs(",", file);
+        else
+            fprintf(file, ",%.4f", value);
+    }
+}
+
+Profiler::Profiler()
+{
+}
+
+Profiler::~Profiler()
+{
+    if (m_Csv)
+        fclose(m_Csv);
+    for (Slot& slot : m_Slots)
+    {
+        if (!slot.queries.empty())
+            glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+    }
+    if (m_VAO)
+    {
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(1, &m_VBO);
+        glDeleteBuffers(1, &m_EBO);
+    }
+}
+
+int Profiler::zone(const char* name, bool gpu)
+{
+    m_Zones.push_back({name, gpu});
+    m_ZoneStart.resize(m_Zones.size());
+    m_CpuTotal.push_back(0.0);
+    m_GpuTotal.push_back(0.0);
+    m_GpuCount.push_back(0);
+    return (int)m_Zones.size() - 1;
+}
+
+bool Profiler::openCsv(const std::string& path)
+{
+    m_Csv = fopen(path.c_str(), "w");
+    if (!m_Csv)
+    {
+        std::cout << "Profiler: failed to open " << path << std::endl;
+        return false;
+    }
+    m_CsvHeader = false;
+    return true;
+}
+
+void Profiler::beginFrame()
+{
+    Slot& slot = m_Slots[m_FrameIndex % Latency];
+    // this slot's queries were issued Latency frames ago; take whatever has arrived
+    if (slot.pending)
+        collect(slot, false);
+
+    size_t zones = m_Zones.size();
+    if (slot.queries.size() < zones)
+    {
+        size_t first = slot.queries.size();
+        slot.queries.resize(zones);
+        glGenQueries((GLsizei)(zones - first), slot.queries.data() + first);
+    }
+    slot.queried.assign(zones, false);
+    slot.times.frame = m_FrameIndex;
+    slot.times.frameMs = 0.0;
+    slot.times.cpuMs.assign(zones, Missing);
+    slot.times.gpuMs.assign(zones, Missing);
+
+    m_InFrame = true;
+    m_ActiveGpuZone = -1;
+    m_FrameStart = std::chrono::steady_clock::now();
+    Trace::begin("frame");
+}
+
+void Profiler::endFrame()
+{
+    if (!m_InFrame)
+        return;
+
+    Slot& slot = m_Slots[m_FrameIndex % Latency];
+    slot.times.frameMs = milliseconds(m_FrameStart, std::chrono::steady_clock::now());
+    slot.pending = true;
+    m_InFrame = false;
+    Trace::end();
+    m_FrameIndex++;
+}
+
+void Profiler::begin(int zone)
+{
+    if (!m_InFrame)
+        return;
+
+    Slot& slot = m_Slots[m_FrameIndex % Latency];
+    // a zone's query can only run once per frame, so a repeat is timed on the CPU only
+    if (m_Zones[zone].gpu && m_ActiveGpuZone < 0 && !slot.queried[zone])
+    {
+        glBeginQuery(GL_TIME_ELAPSED, slot.queries[zone]);
+        m_ActiveGpuZone = zone;
+    }
+    m_ZoneStart[zone] = std::chrono::steady_clock::now();
+    Trace::begin(m_Zones[zone].name);
+}
+
+void Profiler::end(int zone)
+{
+    if (!m_InFrame)
+        return;
+
+    Trace::end();
+    Slot& slot = m_Slots[m_FrameIndex % Latency];
+    double ms = milliseconds(m_ZoneStart[zone], std::chrono::steady_clock::now());
+    double& cpu = slot.times.cpuMs[zone];
+    cpu = std::isnan(cpu) ? ms : cpu + ms;
+
+    if (m_ActiveGpuZone == zone)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        slot.queried[zone] = true;
+        m_ActiveGpuZone = -1;
+    }
+}
+
+void Profiler::collect(Slot& slot, bool wait)
+{
+    for (size_t i = 0; i < slot.queried.size(); i++)
+    {
+        if (!slot.queried[i])
+            continue;
+
+        GLuint available = GL_TRUE;
+        if (!wait)
+            glGetQueryObjectuiv(slot.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &nanoseconds);
+            slot.times.gpuMs[i] = (double)nanoseconds * 1e-6;
+        }
+    }
+    slot.pending = false;
+    record(slot.times);
+}
+
+void Profiler::record(const FrameTimes& times)
+{
+    m_History.push_back(times);
+    if (m_History.size() > History)
+        m_History.pop_front();
+
+    m_Frames++;
+    m_FrameTotal += times.frameMs;
+    for (size_t i = 0; i < m_Zones.size(); i++)
+    {
+        if (!std::isnan(times.cpuMs[i]))
+            m_CpuTotal[i] += times.cpuMs[i];
+        if (!std::isnan(times.gpuMs[i]))
+        {
+            m_GpuTotal[i] += times.gpuMs[i];
+            m_GpuCount[i]++;
+        }
+    }
+
+    if (!m_Csv)
+        return;
+    if (!m_CsvHeader)
+    {
+        fputs("frame,frame_ms", m_Csv);
+        for (const Zone& zone : m_Zones)
+            fprintf(m_Csv, ",%s_cpu_ms,%s_gpu_ms", zone.name, zone.name);
+        fputs("\n", m_Csv);
+        m_CsvHeader = true;
+    }
+    fprintf(m_Csv, "%lld,%.4f", times.frame, times.frameMs);
+    for (size_t i = 0; i < m_Zones.size(); i++)
+    {
+        writeValue(m_Csv, times.cpuMs[i]);
+        writeValue(m_Csv, times.gpuMs[i]);
+    }
+    fputs("\n", m_Csv);
+}
+
+void Profiler::addQuad(float x0, float y0, float x1, float y1, const unsigned char color[4])
+{
+    const float corners[4][2] = {{x0, y0}, {x1, y0}, {x1, y1}, {x0, y1}};
+    for (const float* corner : corners)
+    {
+        OverlayVertex vertex = {corner[0], corner[1], 0.0f, {color[0], color[1], color[2], color[3]}};
+        m_Vertices.push_back(vertex);
+    }
+}
+
+void Profiler::addText(float x, float y, const std::string& text, const unsigned char color[4])
+{
+    // stb_easy_font writes quads in the same 16-byte layout as OverlayVertex; no character takes 70 vertices
+    size_t first = m_Vertices.size();
+    m_Vertices.resize(first + text.size() * 70);
+    std::string copy = text;
+    unsigned char rgba[4] = {color[0], color[1], color[2], color[3]};
+    int quads = stb_easy_font_print(x, y, &copy[0], rgba, m_Vertices.data() + first, (int)((m_Vertices.size() - first) * sizeof(OverlayVertex)));
+    m_Vertices.resize(first + quads * 4);
+}
+
+void Profiler::drawOverlay(int width, int height, const std::vector<std::string>& extra)
+{
+    size_t zones = m_Zones.size();
+    m_Vertices.clear();
+
+    // averages over the frames on the graph
+    std::vector<double> cpuAverage(zones, 0.0), gpuAverage(zones, 0.0);
+    std::vector<int> cpuCount(zones, 0), gpuCount(zones, 0);
+    double frameAverage = 0.0;
+    for (const FrameTimes& times : m_History)
+    {
+        frameAverage += times.frameMs;
+        for (size_t i = 0; i < zones; i++)
+        {
+            if (!std::isnan(times.cpuMs[i]))
+            {
+                cpuAverage[i] += times.cpuMs[i];
+                cpuCount[i]++;
+            }
+            if (!std::isnan(times.gpuMs[i]))
+            {
+                gpuAverage[i] += times.gpuMs[i];
+                gpuCount[i]++;
+            }
+        }
+    }
+    if (!m_History.empty())
+        frameAverage /= (double)m_History.size();
+
+    float left = Margin + Padding;
+    float top = Margin + Padding;
+    float graphWidth = BarWidth * History;
+    float panelHeight = Padding * 2.0f + LineHeight + GraphHeight + Padding + LineHeight * (float)zones;
+    if (!extra.empty())
+        panelHeight += Padding + LineHeight * (float)extra.size();
+    addQuad(Margin, Margin, Margin + graphWidth + Padding * 2.0f, Margin + panelHeight, Panel);
+
+    char line[128];
+    snprintf(line, sizeof(line), "frame %.2f ms (%.0f fps)  -  line at 16.7 ms, top at 33.3 ms", frameAverage, frameAverage > 0.0 ? 1000.0 / frameAverage : 0.0);
+    addText(left, top, line, Text);
+
+    // one column per frame, newest on the right: the whole frame in grey behind the zones stacked on top of each other
+    float bottom = top + LineHeight + GraphHeight;
+    float pixelsPerMs = GraphHeight / (float)MaxMs;
+    float x = left + graphWidth - BarWidth * (float)m_History.size();
+    for (const FrameTimes& times : m_History)
+    {
+        float frameTop = bottom - (float)std::min(times.frameMs, MaxMs) * pixelsPerMs;
+        addQuad(x, frameTop, x + BarWidth, bottom, FrameBar);
+
+        double stacked = 0.0;
+        for (size_t i = 0; i < zones && stacked < MaxMs; i++)
+        {
+            double ms = m_Zones[i].gpu ? times.gpuMs[i] : times.cpuMs[i];
+            if (std::isnan(ms) || ms <= 0.0)
+                continue;
+            double next = std::min(stacked + ms, MaxMs);
+            addQuad(x, bottom - (float)next * pixelsPerMs, x + BarWidth, bottom - (float)stacked * pixelsPerMs, Palette[i % 8]);
+            stacked = next;
+        }
+        x += BarWidth;
+    }
+    float budget = bottom - (float)BudgetMs * pixelsPerMs;
+    addQuad(left, budget, left + graphWidth, budget + 1.0f, Budget);
+
+    float y = bottom + Padding;
+    for (size_t i = 0; i < zones; i++)
+    {
+        addQuad(left, y, left + 6.0f, y + 6.0f, Palette[i % 8]);
+        int length = snprintf(line, sizeof(line), "%-10s cpu %6.2f ms", m_Zones[i].name, cpuCount[i] ? cpuAverage[i] / cpuCount[i] : 0.0);
+        if (m_Zones[i].gpu && length > 0 && length < (int)sizeof(line))
+        {
+            if (gpuCount[i])
+                snprintf(line + length, sizeof(line) - length, "   gpu %6.2f ms", gpuAverage[i] / gpuCount[i]);
+            else
+                snprintf(line + length, sizeof(line) - length, "   gpu      -");
+        }
+        addText(left + 10.0f, y, line, Text);
+        y += LineHeight;
+    }
+    if (!extra.empty())
+        y += Padding;
+    for (const std::string& text : extra)
+    {
+        addText(left, y, text, Text);
+        y += LineHeight;
+    }
+
+    size_t quads = m_Vertices.size() / 4;
+    if (!m_Shader)
+    {
+        m_Shader = std::make_unique<Shader>("profiler_overlay.vs", "profiler_overlay.fs");
+        m_ViewportUniform = m_Shader->uniform("viewport");
+
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(1, &m_VBO);
+        glGenBuffers(1, &m_EBO);
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(OverlayVertex), (void*)offsetof(OverlayVertex, color));
+        glEnableVertexAttribArray(1);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    }
+    glBindVertexArray(m_VAO);
+    if (quads > m_QuadCapacity)
+    {
+        // two triangles per quad, the same for every quad, so the indices only grow
+        m_QuadCapacity = std::max(quads, m_QuadCapacity * 2);
+        std::vector<unsigned int> indices;
+        indices.reserve(m_QuadCapacity * 6);
+        for (unsigned int quad = 0; quad < m_QuadCapacity; quad++)
+        {
+            const unsigned int corners[6] = {0, 1, 2, 0, 2, 3};
+            for (unsigned int corner : corners)
+                indices.push_back(quad * 4 + corner);
+        }
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    // orphan last frame's vertices rather than wait for the GPU to finish with them
+    glBufferData(GL_ARRAY_BUFFER, m_QuadCapacity * 4 * sizeof(OverlayVertex), NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, m_Vertices.size() * sizeof(OverlayVertex), m_Vertices.data());
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_Shader->use();
+    m_Shader->set(m_ViewportUniform, glm::vec2((float)width, (float)height));
+    glDrawElements(GL_TRIANGLES, (GLsizei)(quads * 6), GL_UNSIGNED_INT, (void*)0);
+    glBindVertexArray(0);
+
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+    if (!blend)
+        glDisable(GL_BLEND);
+}
+
+void Profiler::finish()
+{
+    // the frames still in flight, oldest first; at exit it is fine to wait for them
+    for (int i = 0; i < Latency; i++)
+    {
+        Slot& slot = m_Slots[(m_FrameIndex + i) % Latency];
+        if (slot.pending)
+            collect(slot, true);
+    }
+    if (m_Csv)
+    {
+        fclose(m_Csv);
+        m_Csv = nullptr;
+    }
+    if (m_Frames == 0)
+        return;
+
+    std::cout << "Profiler: " << m_Frames << " frames, " << m_FrameTotal / m_Frames << " ms a frame";
+    for (size_t i = 0; i < m_Zones.size(); i++)
+    {
+        std::cout << ", " << m_Zones[i].name << " " << m_CpuTotal[i] / m_Frames << " ms";
+        if (m_Zones[i].gpu && m_GpuCount[i])
+            std::cout << " (gpu " << m_GpuTotal[i] / m_GpuCount[i] << " ms)";
+    }
+    std::cout << std::endl;
+}
@@ -0,0 +1,125 @@
+#define GLM_ENABLE_EXPERIMENTAL
+#pragma once
+
+#include "glad/glad.h"
+
+#include "shader_s.h"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Where a frame goes: named zones timed on the CPU with a steady clock and, for zones
+// that wrap GL work, on the GPU with GL_TIME_ELAPSED queries. Each frame gets its own
+// set of queries out of a ring of Latency frames, and a frame's results are only read
+// once its slot comes round again and GL reports them available, so the profiler never
+// waits on the GPU; a result that is still not ready by then is dropped. Finished
+// frames feed a rolling on-screen graph (stb_easy_font text) and, optionally, a CSV file.
+class Profiler
+{
+public:
+    static const int History = 240;
+    static const int Latency = 2;
+
+    // per frame in ms; NaN where a zone did not run, or its GPU time never arrived
+    struct FrameTimes
+    {
+        long long frame = 0;
+        double frameMs = 0.0;
+        std::vector<double> cpuMs;
+        std::vector<double> gpuMs;
+    };
+
+    Profiler();
+    ~Profiler();
+
+    // register every zone before the first frame; the id goes to ProfileZone. GPU zones
+    // must not nest inside each other, since only one GL_TIME_ELAPSED query runs at a time.
+    // Zones also show up as Trace slices, so name must be a string literal
+    int zone(const char* name, bool gpu);
+    // one row per frame: frame, frame_ms, then <zone>_cpu_ms and <zone>_gpu_ms for every zone
+    bool openCsv(const std::string& path);
+
+    void beginFrame();
+    void endFrame();
+    void begin(int zone);
+    void end(int zone);
+
+    // rolling graph of GPU time per zone (CPU time for CPU-only zones) over the last
+    // History frames, with recent averages, in the top-left corner of a width x height viewport;
+    // extra lines are printed under the zones
+    void drawOverlay(int width, int height, const std::vector<std::string>& extra = std::vector<std::string>());
+    // GL thread, at exit: collect the frames still in flight, close the CSV and print averages
+    void finish();
+
+    const std::deque<FrameTimes>& history() const { return m_History; }
+
+private:
+    struct Zone
+    {
+        const char* name;
+        bool gpu;
+    };
+    struct Slot
+    {
+        bool pending = false;
+        FrameTimes times;
+        std::vector<GLuint> queries;
+        std::vector<bool> queried;
+    };
+    struct OverlayVertex
+    {
+        float x, y, z;
+        unsigned char color[4];
+    };
+
+    std::vector<Zone> m_Zones;
+    Slot m_Slots[Latency];
+    long long m_FrameIndex = 0;
+    bool m_InFrame = false;
+    int m_ActiveGpuZone = -1;
+
+    std::chrono::steady_clock::time_point m_FrameStart;
+    std::vector<std::chrono::steady_clock::time_point> m_ZoneStart;
+
+    std::deque<FrameTimes> m_History;
+    long long m_Frames = 0;
+    std::vector<double> m_CpuTotal;
+    std::vector<double> m_GpuTotal;
+    std::vector<long long> m_GpuCount;
+    double m_FrameTotal = 0.0;
+
+    FILE* m_Csv = nullptr;
+    bool m_CsvHeader = false;
+
+    std::unique_ptr<Shader> m_Shader;
+    UniformHandle m_ViewportUniform;
+    GLuint m_VAO = 0;
+    GLuint m_VBO = 0;
+    GLuint m_EBO = 0;
+    size_t m_QuadCapacity = 0;
+    std::vector<OverlayVertex> m_Vertices;
+
+    void collect(Slot& slot, bool wait);
+    void record(const FrameTimes& times);
+    void addQuad(float x0, float y0, float x1, float y1, const unsigned char color[4]);
+    void addText(float x, float y, const std::string& text, const unsigned char color[4]);
+};
+
+// times the enclosing scope as one zone
+class ProfileZone
+{
+public:
+    ProfileZone(Profiler& profiler, int zone) : m_Profiler(profiler), m_Zone(zone) { profiler.begin(zone); }
+    ~ProfileZone() { m_Profiler.end(m_Zone); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler& m_Profiler;
+    int m_Zone;
+};
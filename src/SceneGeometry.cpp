@@ -0,0 +1,35 @@
+#include "SceneGeometry.h"
+
+#include "JobSystem.h"
+
+#include <cmath>
+
+void generateRingMesh(std::vector<float>& vertices, float innerRadius, float outerRadius, int segments){
+    // an outer and an inner vertex per segment, 5 floats each
+    vertices.assign((size_t)(segments + 1) * 10, 0.0f);
+    JobSystem::global().parallelFor((size_t)segments + 1, 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float theta = 2.0f * M_PI * float(i) / float(segments);
+            float x = cos(theta);
+            float z = sin(theta);
+            float* vertex = &vertices[i * 10];
+
+            vertex[0] = outerRadius * x;
+            vertex[1] = 0.0f;
+            vertex[2] = outerRadius * z;
+            vertex[3] = 1.0f;
+            vertex[4] = float(i) / segments;
+
+            vertex[5] = innerRadius * x;
+            vertex[6] = 0.0f;
+            vertex[7] = innerRadius * z;
+            vertex[8] = 0.0f;
+            vertex[9] = float(i) / segments;
+        }
+    });
+}
+
+float spinAngle(double time, double rate)
+{
+    return static_cast<float>(std::fmod(time * rate, 6.283185307179586));
+}
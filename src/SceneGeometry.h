@@ -0,0 +1,12 @@
+#pragma once
+
+#include <vector>
+
+// Small pieces of the scene main builds, in their own unit so the benchmarks run the same code.
+
+// a flat annulus in the XZ plane as a triangle strip: per segment an outer and an inner
+// vertex of position and texture coordinates, 5 floats each, drawn unindexed
+void generateRingMesh(std::vector<float>& vertices, float innerRadius, float outerRadius, int segments);
+
+// time * rate reduced to one turn while still in double, so rotations stay smooth however long the app has run
+float spinAngle(double time, double rate);
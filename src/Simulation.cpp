@@ -0,0 +1,131 @@
+#include "Simulation.h"
+
+#include "JobSystem.h"
+
+#include <cmath>
+
+Simulation::Simulation(double fixedStep, Integrator integrator)
+    : m_FixedStep(fixedStep), m_Integrator(integrator), m_SimdLevel(detectSimdLevel()), m_Kernel(gravityKernel(m_SimdLevel))
+{
+    m_Tree.kernel = m_Kernel;
+}
+
+size_t Simulation::addBody(double mass, const glm::dvec3& position, const glm::dvec3& velocity)
+{
+    m_X.push_back(position.x);
+    m_Y.push_back(position.y);
+    m_Z.push_back(position.z);
+    m_VX.push_back(velocity.x);
+    m_VY.push_back(velocity.y);
+    m_VZ.push_back(velocity.z);
+    m_AX.push_back(0.0);
+    m_AY.push_back(0.0);
+    m_AZ.push_back(0.0);
+    m_Mass.push_back(mass);
+    m_AccelerationsValid = false;
+    return m_Mass.size() - 1;
+}
+
+void Simulation::removeNetMomentum()
+{
+    glm::dvec3 momentum(0.0);
+    double totalMass = 0.0;
+    for (size_t i = 0; i < m_Mass.size(); i++)
+    {
+        momentum += m_Mass[i] * velocity(i);
+        totalMass += m_Mass[i];
+    }
+    if (totalMass <= 0.0)
+        return;
+
+    glm::dvec3 drift = momentum / totalMass;
+    for (size_t i = 0; i < m_Mass.size(); i++)
+    {
+        m_VX[i] -= drift.x;
+        m_VY[i] -= drift.y;
+        m_VZ[i] -= drift.z;
+    }
+}
+
+int Simulation::advance(double frameTime, int maxSteps)
+{
+    m_Accumulator += frameTime;
+    int steps = 0;
+    while (m_Accumulator >= m_FixedStep && steps < maxSteps)
+    {
+        step(m_FixedStep);
+        m_Accumulator -= m_FixedStep;
+        steps++;
+    }
+    // falling further behind every frame would only make the next frame slower
+    if (steps == maxSteps && m_Accumulator >= m_FixedStep)
+        m_Accumulator = 0.0;
+    return steps;
+}
+
+void Simulation::step(double dt)
+{
+    if (m_Integrator == Integrator::Leapfrog)
+    {
+        leapfrog(dt);
+    }
+    else
+    {
+        // Yoshida 1990: leapfrog composed with weights w1, w0, w1 cancels the 3rd order error
+        const double cbrt2 = std::cbrt(2.0);
+        const double w1 = 1.0 / (2.0 - cbrt2);
+        const double w0 = -cbrt2 / (2.0 - cbrt2);
+        leapfrog(w1 * dt);
+        leapfrog(w0 * dt);
+        leapfrog(w1 * dt);
+    }
+    m_Time += dt;
+}
+
+void Simulation::leapfrog(double dt)
+{
+    // accelerations from the end of the previous step are still valid for this one's first kick
+    if (!m_AccelerationsValid)
+        computeAccelerations();
+
+    const size_t n = m_Mass.size();
+    const double halfStep = 0.5 * dt;
+    for (size_t i = 0; i < n; i++)
+    {
+        m_VX[i] += halfStep * m_AX[i];
+        m_VY[i] += halfStep * m_AY[i];
+        m_VZ[i] += halfStep * m_AZ[i];
+        m_X[i] += dt * m_VX[i];
+        m_Y[i] += dt * m_VY[i];
+        m_Z[i] += dt * m_VZ[i];
+    }
+
+    computeAccelerations();
+
+    for (size_t i = 0; i < n; i++)
+    {
+        m_VX[i] += halfStep * m_AX[i];
+        m_VY[i] += halfStep * m_AY[i];
+        m_VZ[i] += halfStep * m_AZ[i];
+    }
+}
+
+void Simulation::computeAccelerations()
+{
+    if (solver == Solver::BarnesHut)
+    {
+        // positions change every substep, so the tree is rebuilt from scratch each time
+        m_Tree.build(m_Mass.size(), m_X.data(), m_Y.data(), m_Z.data(), m_Mass.data());
+        m_Tree.accelerations(theta, softening * softening, m_AX.data(), m_AY.data(), m_AZ.data());
+        m_AccelerationsValid = true;
+        return;
+    }
+
+    // each job takes a run of target bodies against all of them; small systems run inline
+    const size_t n = m_Mass.size();
+    const double eps2 = softening * softening;
+    JobSystem::global().parallelFor(n, 256, [&](size_t begin, size_t end) {
+        m_Kernel(begin, end, n, m_X.data(), m_Y.data(), m_Z.data(), m_Mass.data(), eps2, m_AX.data(), m_AY.data(), m_AZ.data());
+    });
+    m_AccelerationsValid = true;
+}
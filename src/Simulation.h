@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "BarnesHut.h"
+#include "GravityKernel.h"
+
+#include <cstddef>
+#include <vector>
+
+// Point-mass gravity for the bodies in the scene, integrated with a symplectic
+// scheme on a fixed timestep that is independent of the frame rate.
+// State is kept structure-of-arrays so the pairwise force kernel walks contiguous
+// doubles; the widest SIMD kernel the CPU supports is picked at construction.
+// Large populations can switch to a Barnes-Hut tree instead of direct summation.
+// Units are the scene's, with G = 1.
+class Simulation
+{
+public:
+    enum class Integrator
+    {
+        Leapfrog, // kick-drift-kick, 2nd order, one force evaluation per step
+        Yoshida4  // three leapfrog substeps, 4th order, three force evaluations per step
+    };
+
+    enum class Solver
+    {
+        Direct,   // all pairs, O(N^2), exact up to rounding
+        BarnesHut // octree, O(N log N), error controlled by theta
+    };
+
+    explicit Simulation(double fixedStep = 1.0 / 120.0, Integrator integrator = Integrator::Yoshida4);
+
+    size_t addBody(double mass, const glm::dvec3& position, const glm::dvec3& velocity);
+    size_t size() const { return m_Mass.size(); }
+
+    glm::dvec3 position(size_t i) const { return glm::dvec3(m_X[i], m_Y[i], m_Z[i]); }
+    glm::dvec3 velocity(size_t i) const { return glm::dvec3(m_VX[i], m_VY[i], m_VZ[i]); }
+    double mass(size_t i) const { return m_Mass[i]; }
+
+    // shift velocities so the total momentum is zero and the system does not drift
+    void removeNetMomentum();
+
+    // runs every whole fixed step that fits in frameTime plus what was left over last call;
+    // after a long stall at most maxSteps run and the rest is dropped. Returns the steps taken
+    int advance(double frameTime, int maxSteps = 8);
+    void step(double dt);
+
+    double time() const { return m_Time; }
+    double fixedStep() const { return m_FixedStep; }
+    SimdLevel simdLevel() const { return m_SimdLevel; }
+
+    // Plummer softening length; keeps close encounters from blowing up the step.
+    // Must stay above zero: it is also what makes a body's pull on itself vanish
+    double softening = 1e-3;
+
+    Solver solver = Solver::Direct;
+    // Barnes-Hut opening angle: a cell narrower than theta times its distance is taken as a point mass
+    double theta = 0.5;
+
+private:
+    std::vector<double> m_X, m_Y, m_Z;
+    std::vector<double> m_VX, m_VY, m_VZ;
+    std::vector<double> m_AX, m_AY, m_AZ;
+    std::vector<double> m_Mass;
+
+    double m_FixedStep;
+    Integrator m_Integrator;
+    SimdLevel m_SimdLevel;
+    GravityKernelFn m_Kernel;
+    BarnesHutTree m_Tree;
+    double m_Accumulator = 0.0;
+    double m_Time = 0.0;
+    bool m_AccelerationsValid = false;
+
+    void leapfrog(double dt);
+    void computeAccelerations();
+};
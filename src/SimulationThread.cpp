@@ -0,0 +1,108 @@
+#include "SimulationThread.h"
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+SimulationThread::SimulationThread(Simulation simulation, int maxSteps)
+    : m_Simulation(std::move(simulation)), m_MaxSteps(maxSteps)
+{
+    // every buffer starts out as the initial state, so the reader has something before the first step
+    for (int i = 0; i < 3; i++)
+    {
+        Snapshot& snapshot = m_Snapshots.buffer(i);
+        for (size_t body = 0; body < m_Simulation.size(); body++)
+            snapshot.current.push_back(m_Simulation.position(body));
+        snapshot.previous = snapshot.current;
+    }
+}
+
+SimulationThread::~SimulationThread()
+{
+    stop();
+}
+
+void SimulationThread::start(std::function<double()> clock)
+{
+    if (m_Running)
+        return;
+
+    // the current state is "now" on the new clock
+    m_SimulatedTime = clock();
+    Snapshot& snapshot = m_Snapshots.back();
+    snapshot.time = m_SimulatedTime;
+    for (size_t body = 0; body < m_Simulation.size(); body++)
+        snapshot.current[body] = snapshot.previous[body] = m_Simulation.position(body);
+    m_Snapshots.publish();
+
+    m_Running = true;
+    m_Thread = std::thread(&SimulationThread::threadLoop, this, std::move(clock));
+}
+
+void SimulationThread::stop()
+{
+    m_Running = false;
+    if (m_Thread.joinable())
+        m_Thread.join();
+}
+
+void SimulationThread::stepTo(double time)
+{
+    const double step = m_Simulation.fixedStep();
+    if (time - m_SimulatedTime > m_MaxSteps * step)
+        m_SimulatedTime = time - m_MaxSteps * step;
+    while (m_SimulatedTime + step <= time)
+        stepOnce();
+}
+
+void SimulationThread::stepOnce()
+{
+    TraceScope trace("simulation step");
+    Snapshot& snapshot = m_Snapshots.back();
+    const size_t n = m_Simulation.size();
+    snapshot.previous.resize(n);
+    snapshot.current.resize(n);
+
+    for (size_t body = 0; body < n; body++)
+        snapshot.previous[body] = m_Simulation.position(body);
+    m_Simulation.step(m_Simulation.fixedStep());
+    m_SimulatedTime += m_Simulation.fixedStep();
+    for (size_t body = 0; body < n; body++)
+        snapshot.current[body] = m_Simulation.position(body);
+
+    snapshot.time = m_SimulatedTime;
+    m_Snapshots.publish();
+}
+
+void SimulationThread::threadLoop(std::function<double()> clock)
+{
+    Trace::setThreadName("simulation");
+    const double step = m_Simulation.fixedStep();
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        // after a stall, or when a step costs more than it simulates, catch up at most maxSteps
+        double now = clock();
+        if (now - m_SimulatedTime > m_MaxSteps * step)
+            m_SimulatedTime = now - m_MaxSteps * step;
+        while (m_SimulatedTime + step <= now && m_Running.load(std::memory_order_relaxed))
+            stepOnce();
+
+        double wait = m_SimulatedTime + step - clock();
+        if (wait > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait));
+    }
+}
+
+void SimulationThread::sample(double time, std::vector<glm::dvec3>& positions)
+{
+    m_Snapshots.update();
+    const Snapshot& snapshot = m_Snapshots.front();
+
+    // showing the state one step before `time` keeps it between the two published ones
+    double alpha = std::min(std::max((time - snapshot.time) / m_Simulation.fixedStep(), 0.0), 1.0);
+    positions.resize(snapshot.current.size());
+    for (size_t body = 0; body < positions.size(); body++)
+        positions[body] = glm::mix(snapshot.previous[body], snapshot.current[body], alpha);
+}
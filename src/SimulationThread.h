@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Simulation.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs a Simulation at its fixed step on a thread of its own, in step with a
+// clock, so its cost no longer adds to frame time. After every step it publishes
+// the body positions before and after the step through a triple buffer; the
+// render thread interpolates between the two, which puts it one fixed step
+// behind the simulation but moves bodies smoothly at any frame rate.
+class SimulationThread
+{
+public:
+    explicit SimulationThread(Simulation simulation, int maxSteps = 8);
+    ~SimulationThread();
+
+    // only while the thread is not running
+    Simulation& simulation() { return m_Simulation; }
+
+    // steps on a new thread until stop(); clock returns seconds and may be called from it.
+    // If the simulation falls more than maxSteps behind, the time it missed is dropped
+    void start(std::function<double()> clock);
+    void stop();
+
+    // without a thread: step on the caller's thread until the simulation reaches `time`, for
+    // runs that must be deterministic
+    void stepTo(double time);
+
+    // render thread: positions at `time` on the same clock, interpolated between the last two steps
+    void sample(double time, std::vector<glm::dvec3>& positions);
+
+private:
+    struct Snapshot
+    {
+        double time = 0.0; // clock time of `current`; `previous` is one step earlier
+        std::vector<glm::dvec3> previous;
+        std::vector<glm::dvec3> current;
+    };
+
+    Simulation m_Simulation;
+    int m_MaxSteps;
+    // clock time the simulation state corresponds to; only the stepping thread touches it
+    double m_SimulatedTime = 0.0;
+
+    TripleBuffer<Snapshot> m_Snapshots;
+
+    std::thread m_Thread;
+    std::atomic<bool> m_Running{ false };
+
+    void stepOnce();
+    void threadLoop(std::function<double()> clock);
+};
@@ -0,0 +1,115 @@
+#include "SkyboxSwitcher.h"
+
+#include <iostream>
+
+SkyboxSwitcher::SkyboxSwitcher(AssetLoader& loader, double evictAfter)
+    : m_Loader(loader), m_Current(-1), m_Requested(-1), evictAfter(evictAfter)
+{
+}
+
+int SkyboxSwitcher::add(const std::vector<std::string>& faces)
+{
+    std::unique_ptr<Cubemap> cubemap(new Cubemap());
+    cubemap->faces = faces;
+    m_Cubemaps.push_back(std::move(cubemap));
+    return (int)m_Cubemaps.size() - 1;
+}
+
+void SkyboxSwitcher::show(int index)
+{
+    if (index < 0 || index >= (int)m_Cubemaps.size())
+        return;
+
+    m_Requested = index;
+    if (m_Cubemaps[index]->textureID == 0)
+        startLoading(*m_Cubemaps[index]);
+}
+
+void SkyboxSwitcher::next()
+{
+    if (m_Cubemaps.empty())
+        return;
+
+    int from = m_Requested >= 0 ? m_Requested : m_Current;
+    show((from + 1) % (int)m_Cubemaps.size());
+}
+
+void SkyboxSwitcher::startLoading(Cubemap& cubemap)
+{
+    glGenTextures(1, &cubemap.textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap.textureID);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    cubemap.facesLoaded = 0;
+    cubemap.facesFailed = 0;
+    unsigned int textureID = cubemap.textureID;
+    Cubemap* target = &cubemap;
+    for (unsigned int i = 0; i < cubemap.faces.size(); i++)
+    {
+        m_Loader.load(cubemap.faces[i], 3, [target, textureID, i](const DecodedImage& image, const void* pixels) {
+            if (!image.pixels)
+            {
+                std::cout << "Cubemap texture failed to load at path: " << image.path << std::endl;
+                target->facesFailed++;
+                return;
+            }
+            glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+            AssetLoader::texImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, image, pixels);
+            if (image.levels > 1)
+                glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            target->facesLoaded++;
+        });
+    }
+}
+
+void SkyboxSwitcher::update(double now)
+{
+    for (int i = 0; i < (int)m_Cubemaps.size(); i++)
+    {
+        // once every face has come back, a cubemap with a missing face is given up on
+        Cubemap& cubemap = *m_Cubemaps[i];
+        if (cubemap.facesFailed == 0 || cubemap.facesLoaded + cubemap.facesFailed < (int)cubemap.faces.size())
+            continue;
+        glDeleteTextures(1, &cubemap.textureID);
+        cubemap.textureID = 0;
+        cubemap.facesLoaded = 0;
+        cubemap.facesFailed = 0;
+        if (m_Requested == i)
+            m_Requested = -1;
+    }
+
+    if (m_Requested >= 0 && resident(*m_Cubemaps[m_Requested]))
+    {
+        if (m_Current >= 0)
+            m_Cubemaps[m_Current]->lastUsed = now;
+        m_Current = m_Requested;
+        m_Requested = -1;
+    }
+
+    for (int i = 0; i < (int)m_Cubemaps.size(); i++)
+    {
+        Cubemap& cubemap = *m_Cubemaps[i];
+        if (i == m_Current)
+        {
+            cubemap.lastUsed = now;
+            continue;
+        }
+        // only finished, idle cubemaps are dropped; one still loading has pending callbacks
+        if (i != m_Requested && resident(cubemap) && now - cubemap.lastUsed > evictAfter)
+        {
+            glDeleteTextures(1, &cubemap.textureID);
+            cubemap.textureID = 0;
+            cubemap.facesLoaded = 0;
+        }
+    }
+}
+
+unsigned int SkyboxSwitcher::texture() const
+{
+    return m_Current >= 0 ? m_Cubemaps[m_Current]->textureID : 0;
+}
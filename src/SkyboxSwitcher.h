@@ -0,0 +1,54 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include "AssetLoader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Holds the available skybox cubemaps and loads each one only when it is first shown.
+// A requested skybox is decoded in the background through the AssetLoader; the current
+// one stays on screen until all six faces of the new one are resident. Cubemaps that
+// have not been shown for evictAfter seconds are deleted again. If a face fails to load,
+// the cubemap is dropped and the current one stays; showing it again retries the load.
+class SkyboxSwitcher
+{
+private:
+    struct Cubemap
+    {
+        std::vector<std::string> faces;
+        unsigned int textureID = 0;
+        int facesLoaded = 0;
+        int facesFailed = 0;
+        double lastUsed = 0.0;
+    };
+
+    AssetLoader& m_Loader;
+    // unique_ptr keeps each Cubemap at a fixed address for the loader callbacks
+    std::vector<std::unique_ptr<Cubemap>> m_Cubemaps;
+    int m_Current;
+    int m_Requested;
+
+    void startLoading(Cubemap& cubemap);
+    bool resident(const Cubemap& cubemap) const { return cubemap.textureID != 0 && cubemap.facesLoaded == (int)cubemap.faces.size(); }
+
+public:
+    double evictAfter;
+
+    SkyboxSwitcher(AssetLoader& loader, double evictAfter = 60.0);
+
+    // registers a cubemap without loading it, returns its index
+    int add(const std::vector<std::string>& faces);
+
+    // switch to a cubemap (or the next one) once it is loaded
+    void show(int index);
+    void next();
+
+    // once per frame after AssetLoader::poll(): swaps in a finished cubemap and evicts stale ones
+    void update(double now);
+
+    // cubemap to draw this frame, 0 before the first one is resident
+    unsigned int texture() const;
+};
@@ -15,6 +15,9 @@
 
 #include "glm/mat4x4.hpp"
 
+#include "SphereMesh.h"
+#include "AssetLoader.h"
+
 #include <memory>
 #include <vector>
 
@@ -22,17 +25,16 @@ class Sphere
 {
 private:
 
-    unsigned int m_VAO;
-    unsigned int m_VBO;
-    int m_numVertices;
-
-    std::vector<float> vertices;
-    std::vector<float> indices;
-
-    float x, y, z;
+    std::shared_ptr<SphereMesh> m_Meshes[SphereLOD::Levels];
+    float m_Radius;
+    // the SphereLOD level it was last drawn with
+    int m_Level;
+    float m_PixelScale;
 
     unsigned int m_Texture;
 
+    UniformHandle m_ModelUniform;
+
 public:
     glm::mat4 model;
     Shader m_Shader;
@@ -40,10 +42,12 @@ public:
     glm::mat4 view;
     glm::mat4 projection;
     
-    Sphere(const float r, const char* vsFile, const char* fsFile, glm::mat4 model, glm::mat4 view, glm::mat4 projection, std::string texFile);
+    Sphere(const float r, const char* vsFile, const char* fsFile, glm::mat4 model, glm::mat4 view, glm::mat4 projection, std::string texFile, AssetLoader& loader);
     ~Sphere();
-    void initBuffer(int numRows, int numCols, float radius);
-    void initTexture(std::string texName);
+    void initTexture(std::string texName, AssetLoader& loader);
+    // what the sphere's size on screen is measured with when choosing its level of detail;
+    // until it is called the sphere is drawn at the coarsest level
+    void setProjection(const glm::mat4& projection, int viewportHeight);
+    // model is camera-relative
     void render();
-    void initBySphericalCoords(float radius, float pitch, float heading);
 };
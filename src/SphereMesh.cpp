@@ -0,0 +1,166 @@
+#include "SphereMesh.h"
+
+#include "JobSystem.h"
+#include "Trace.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+SphereMesh::SphereMesh(int numRows, int numCols)
+{
+    TraceScope trace("sphere mesh");
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    generate(numRows, numCols, vertices, indices);
+    m_numIndices = (int)indices.size();
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+
+    glBindVertexArray(m_VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    setupAttributes();
+
+    glBindVertexArray(0);
+}
+
+void SphereMesh::setupAttributes() const
+{
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
+std::shared_ptr<SphereMesh> SphereMesh::Get(int numRows, int numCols)
+{
+    // meshes live for the whole run, like every other GL object in the app
+    static std::map<std::pair<int, int>, std::shared_ptr<SphereMesh>> cache;
+
+    std::shared_ptr<SphereMesh>& mesh = cache[std::make_pair(numRows, numCols)];
+    if (!mesh)
+        mesh = std::shared_ptr<SphereMesh>(new SphereMesh(numRows, numCols));
+    return mesh;
+}
+
+void SphereMesh::generate(int numRows, int numCols, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    float pitchAngle = 180.0f / (float)numRows;
+    float headAngle = 360.0f / (float)numCols;
+
+    // the first and last rows touch a pole, so one triangle of each quad collapses and is skipped;
+    // with that known up front, every row knows where its vertices and indices go and rows are independent
+    std::vector<size_t> firstIndex(numRows + 1, 0);
+    for (int row = 0; row < numRows; row++)
+        firstIndex[row + 1] = firstIndex[row] + (size_t)numCols * 3 * ((row != 0) + (row != numRows - 1));
+
+    const size_t stride = numCols + 1;
+    vertices.assign((size_t)(numRows + 1) * stride * 8, 0.0f);
+    indices.assign(firstIndex[numRows], 0);
+
+    JobSystem::global().parallelFor((size_t)numRows + 1, 16, [&](size_t firstRow, size_t lastRow) {
+        for (size_t row = firstRow; row < lastRow; row++)
+        {
+            // one shared vertex per grid point; the extra column duplicates the seam for its u = 1.0
+            float pitch = -90.0f + row * pitchAngle;
+            float* vertex = &vertices[row * stride * 8];
+            for (int col = 0; col <= numCols; col++, vertex += 8)
+            {
+                float heading = col * headAngle;
+
+                float x = cosf(glm::radians(pitch)) * sinf(glm::radians(heading));
+                float y = -sinf(glm::radians(pitch));
+                float z = cosf(glm::radians(pitch)) * cosf(glm::radians(heading));
+
+                vertex[0] = x;
+                vertex[1] = y;
+                vertex[2] = z;
+
+                vertex[3] = x;
+                vertex[4] = y;
+                vertex[5] = z;
+
+                vertex[6] = heading / 360.0f;
+                vertex[7] = (90.0f + pitch) / 180.0f;
+            }
+
+            if ((int)row == numRows)
+                continue;
+            unsigned int* index = indices.data() + firstIndex[row];
+            for (int col = 0; col < numCols; col++)
+            {
+                unsigned int current = (unsigned int)(row * stride + col);
+                unsigned int below = current + (unsigned int)stride;
+
+                if (row != 0)
+                {
+                    *index++ = current;
+                    *index++ = current + 1;
+                    *index++ = below;
+                }
+                if ((int)row != numRows - 1)
+                {
+                    *index++ = current + 1;
+                    *index++ = below + 1;
+                    *index++ = below;
+                }
+            }
+        }
+    });
+}
+
+void SphereMesh::draw() const
+{
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+float SphereLOD::pixelScale(const glm::mat4& projection, int viewportHeight)
+{
+    // projection[1][1] is 1 / tan(fovy / 2), and the viewport spans 2 of those units
+    return projection[1][1] * 0.5f * (float)viewportHeight;
+}
+
+int SphereLOD::select(float pixelRadius, int previous)
+{
+    // n segments around a circle of radius R stray R (1 - cos(pi / n)) ~ R pi^2 / (2 n^2)
+    // from it, which stays under a quarter pixel for n >= pi sqrt(8 R)
+    const float Hysteresis = 0.3f;
+    float segments = 3.14159265f * std::sqrt(8.0f * std::max(pixelRadius, 0.0f));
+    float ideal = std::log2(std::max(segments, 1.0f) / (float)tessellation(0));
+    ideal = std::min(std::max(ideal, 0.0f), (float)(Levels - 1));
+
+    int level = std::min((int)std::ceil(ideal), Levels - 1);
+    if (previous < 0 || previous >= Levels)
+        return level;
+    // previous covers (previous - 1, previous]; stay until ideal is a good way outside that
+    if (ideal > (float)previous + Hysteresis || ideal < (float)previous - 1.0f - Hysteresis)
+        return level;
+    return previous;
+}
+
+int SphereLOD::select(const glm::vec3& center, float radius, float pixelScale, int previous)
+{
+    float distance = glm::length(center);
+    // inside or touching the sphere: it fills the view
+    if (distance <= radius)
+        return Levels - 1;
+    return select(radius * pixelScale / distance, previous);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Indexed unit sphere shared by every Sphere with the same tessellation.
+// Radius is applied through the model matrix, so one VBO/EBO per (rows, cols)
+// is enough for the whole scene.
+class SphereMesh
+{
+private:
+    unsigned int m_VAO;
+    unsigned int m_VBO;
+    unsigned int m_EBO;
+    int m_numIndices;
+
+    SphereMesh(int numRows, int numCols);
+
+public:
+    // returns the cached mesh for this tessellation, building it on first use
+    static std::shared_ptr<SphereMesh> Get(int numRows, int numCols);
+
+    // fills interleaved position/normal/uv vertices (8 floats each) and triangle indices
+    static void generate(int numRows, int numCols, std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+    // binds this mesh's VBO/EBO and sets attributes 0-2 on the currently bound VAO,
+    // so other renderers can build their own VAO around the shared buffers
+    void setupAttributes() const;
+
+    unsigned int VAO() const { return m_VAO; }
+    int indexCount() const { return m_numIndices; }
+
+    void draw() const;
+};
+
+// Level-of-detail chain of sphere meshes, 8x8 at level 0 doubling up to 256x256, picked per
+// body every frame from how big it appears. Each level is used until the silhouette's
+// deviation from a true circle would exceed a quarter of a pixel. Bodies remember their
+// level and only move once they are well into the next one's range, so a body sitting on
+// a threshold does not flicker between two meshes.
+class SphereLOD
+{
+public:
+    static const int Levels = 6;
+
+    // rows and columns of the mesh at `level`
+    static int tessellation(int level) { return 8 << level; }
+    static std::shared_ptr<SphereMesh> mesh(int level) { return SphereMesh::Get(tessellation(level), tessellation(level)); }
+
+    // pixels per unit of size at distance 1, for this projection onto a viewport this many pixels tall
+    static float pixelScale(const glm::mat4& projection, int viewportHeight);
+    // the level for a sphere that covers pixelRadius pixels, given the one it had last frame (-1 for none)
+    static int select(float pixelRadius, int previous);
+    // both at once, for a sphere of `radius` whose centre is `center` in camera-relative coordinates
+    static int select(const glm::vec3& center, float radius, float pixelScale, int previous);
+};
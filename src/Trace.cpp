@@ -0,0 +1,190 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // one cache line
+    struct Event
+    {
+        uint64_t time;
+        const char* name;
+        char phase;
+        char detail[Trace::DetailLength + 1];
+    };
+
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(size_t capacity) : capacity(capacity), events(new Event[capacity]) {}
+
+        // events recorded so far; slot i % capacity holds event i
+        std::atomic<uint64_t> head{ 0 };
+        const size_t capacity;
+        std::unique_ptr<Event[]> events;
+        int id = 0;
+        // only touched under the registry lock
+        std::string name;
+    };
+
+    // buffers outlive their threads, so events from finished threads still get written
+    std::mutex s_RegistryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> s_Buffers;
+    const std::chrono::steady_clock::time_point s_Epoch = std::chrono::steady_clock::now();
+
+    thread_local ThreadBuffer* t_Buffer = nullptr;
+
+    ThreadBuffer* threadBuffer(size_t capacity = Trace::Capacity)
+    {
+        if (!t_Buffer)
+        {
+            size_t size = 1;
+            while (size < capacity)
+                size <<= 1;
+            std::lock_guard<std::mutex> lock(s_RegistryMutex);
+            s_Buffers.push_back(std::make_unique<ThreadBuffer>(size));
+            t_Buffer = s_Buffers.back().get();
+            t_Buffer->id = (int)s_Buffers.size();
+        }
+        return t_Buffer;
+    }
+
+    void record(char phase, const char* name, const char* detail)
+    {
+        ThreadBuffer* buffer = threadBuffer();
+        // only this thread writes head
+        uint64_t index = buffer->head.load(std::memory_order_relaxed);
+        Event& event = buffer->events[index & (buffer->capacity - 1)];
+        event.time = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Epoch).count();
+        event.name = name;
+        event.phase = phase;
+        event.detail[0] = '\0';
+        if (detail)
+        {
+            size_t length = strnlen(detail, Trace::DetailLength);
+            std::memcpy(event.detail, detail, length);
+            event.detail[length] = '\0';
+        }
+        buffer->head.store(index + 1, std::memory_order_release);
+    }
+
+    void writeString(FILE* file, const char* text)
+    {
+        fputc('"', file);
+        for (const char* c = text; *c; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                fprintf(file, "\\%c", *c);
+            else if ((unsigned char)*c < 0x20)
+                fprintf(file, "\\u%04x", (unsigned char)*c);
+            else
+                fputc(*c, file);
+        }
+        fputc('"', file);
+    }
+}
+
+void Trace::begin(const char* name, const char* detail)
+{
+    record('B', name, detail);
+}
+
+void Trace::end()
+{
+    record('E', nullptr, nullptr);
+}
+
+void Trace::instant(const char* name, const char* detail)
+{
+    record('i', name, detail);
+}
+
+void Trace::setThreadName(const std::string& name, size_t capacity)
+{
+    ThreadBuffer* buffer = threadBuffer(capacity);
+    std::lock_guard<std::mutex> lock(s_RegistryMutex);
+    buffer->name = name;
+}
+
+bool Trace::write(const std::string& path)
+{
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        std::cout << "Trace: failed to open " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_RegistryMutex);
+    size_t written = 0;
+    std::vector<Event> events;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : s_Buffers)
+    {
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", written ? ",\n" : "", buffer->id);
+        writeString(file, buffer->name.empty() ? ("thread " + std::to_string(buffer->id)).c_str() : buffer->name.c_str());
+        fputs("}}", file);
+        written++;
+
+        // copy the ring, then drop whatever the owner may have overwritten while we read it
+        uint64_t capacity = buffer->capacity;
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > capacity ? head - capacity : 0;
+        events.clear();
+        for (uint64_t i = first; i < head; i++)
+            events.push_back(buffer->events[i & (capacity - 1)]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t now = buffer->head.load(std::memory_order_relaxed);
+        uint64_t intact = now >= capacity ? now - capacity + 1 : 0;
+        size_t skip = (size_t)(std::max(intact, first) - first);
+        if (skip > events.size())
+            skip = events.size();
+
+        // a wrapped ring can start inside slices whose begin is gone
+        int depth = 0;
+        for (size_t i = skip; i < events.size(); i++)
+        {
+            const Event& event = events[i];
+            if (event.phase == 'E')
+            {
+                if (depth == 0)
+                    continue;
+                depth--;
+            }
+            else if (event.phase == 'B')
+            {
+                depth++;
+            }
+
+            fprintf(file, ",\n{\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", event.phase, buffer->id, (double)event.time * 1e-3);
+            if (event.name)
+            {
+                fputs(",\"name\":", file);
+                writeString(file, event.name);
+            }
+            if (event.phase == 'i')
+                fputs(",\"s\":\"t\"", file);
+            if (event.detail[0])
+            {
+                fputs(",\"args\":{\"detail\":", file);
+                writeString(file, event.detail);
+                fputs("}", file);
+            }
+            fputs("}", file);
+            written++;
+        }
+    }
+    fputs("\n]}\n", file);
+    fclose(file);
+
+    std::cout << "Trace: " << written << " events from " << s_Buffers.size() << " threads to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Always-on timeline of what every thread is doing, for chrome://tracing or Perfetto.
+// Each thread records begin/end/instant events into its own ring of 64-byte events:
+// one timestamp and a few plain stores, no locks and no allocation, so recording can
+// stay on in release builds. write() takes a snapshot of every ring from any thread
+// while the others keep recording; a thread that has wrapped keeps its latest events.
+// Names must be string literals (or otherwise outlive the trace); the optional detail,
+// such as a file name, is copied and cut to DetailLength characters. Rings hold Capacity
+// events (4 MiB) unless the thread asks for another size before it records anything;
+// job workers keep WorkerCapacity, so a machine with dozens of them stays in tens of MiB.
+class Trace
+{
+public:
+    static const size_t Capacity = 1 << 16;
+    static const size_t WorkerCapacity = 1 << 12;
+    static const size_t DetailLength = 46;
+
+    static void begin(const char* name, const char* detail = nullptr);
+    static void end();
+    static void instant(const char* name, const char* detail = nullptr);
+
+    // shown as the thread's name in the viewer. Called before the thread's first event,
+    // it also sizes the thread's ring, rounded up to a power of two
+    static void setThreadName(const std::string& name, size_t capacity = Capacity);
+
+    // every thread's events so far as Chrome trace event JSON
+    static bool write(const std::string& path);
+};
+
+// traces the enclosing scope as one slice
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name, const char* detail = nullptr) { Trace::begin(name, detail); }
+    ~TraceScope() { Trace::end(); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Single-producer, single-consumer hand-off of the latest value without locks.
+// The writer fills back() and publishes it; the reader picks up whatever was
+// published last and keeps reading front() until it asks again. Neither side
+// ever waits for the other: one buffer each, plus a middle one that is swapped
+// with an atomic exchange. Values the reader never got to are overwritten.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // writer thread
+    T& back() { return m_Buffers[m_Back]; }
+    void publish()
+    {
+        uint8_t previous = m_Middle.exchange((uint8_t)(m_Back | Fresh), std::memory_order_acq_rel);
+        m_Back = previous & Index;
+    }
+
+    // reader thread: true if a newer value was published since the last call
+    bool update()
+    {
+        if (!(m_Middle.load(std::memory_order_relaxed) & Fresh))
+            return false;
+        uint8_t previous = m_Middle.exchange(m_Front, std::memory_order_acq_rel);
+        m_Front = previous & Index;
+        return true;
+    }
+    const T& front() const { return m_Buffers[m_Front]; }
+
+    // before either thread starts, e.g. to size every buffer the same
+    T& buffer(int i) { return m_Buffers[i]; }
+
+private:
+    static const uint8_t Index = 3;
+    static const uint8_t Fresh = 4;
+
+    T m_Buffers[3];
+    uint8_t m_Back = 0;
+    uint8_t m_Front = 1;
+    std::atomic<uint8_t> m_Middle{ 2 };
+};
@@ -0,0 +1,143 @@
+// assetpack: builds the memory-mapped archive read by AssetPack.
+// Files are stored verbatim under the path given on the command line, which is the
+// name the program asks for at runtime, so pack the baked .dds files rather than
+// the images they came from.
+//
+//   assetpack output.pack file...
+//   assetpack --verify input.pack
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "AssetPack.h"
+
+struct InputFile
+{
+    std::string name;
+    std::vector<unsigned char> data;
+};
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool writePack(const std::string& output, std::vector<InputFile>& inputs)
+{
+    // sorted so the runtime can binary search the table in place
+    std::sort(inputs.begin(), inputs.end(), [](const InputFile& a, const InputFile& b) { return a.name < b.name; });
+
+    PackHeader header;
+    std::memcpy(header.magic, "SSPK", 4);
+    header.version = AssetPack::Version;
+    header.entryCount = (uint32_t)inputs.size();
+    header.reserved = 0;
+
+    std::vector<PackEntry> entries(inputs.size());
+    size_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        entries[i].nameOffset = (uint32_t)offset;
+        entries[i].nameLength = (uint32_t)inputs[i].name.size();
+        offset += inputs[i].name.size();
+    }
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        offset = alignUp(offset, AssetPack::Alignment);
+        entries[i].offset = offset;
+        entries[i].size = inputs[i].data.size();
+        entries[i].hash = AssetPack::hash(inputs[i].data.data(), inputs[i].data.size());
+        offset += inputs[i].data.size();
+    }
+
+    FILE* file = fopen(output.c_str(), "wb");
+    if (!file)
+    {
+        std::cout << "assetpack: failed to write " << output << std::endl;
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(entries.data(), sizeof(PackEntry), entries.size(), file) == entries.size();
+    for (size_t i = 0; ok && i < inputs.size(); i++)
+        ok = fwrite(inputs[i].name.data(), 1, inputs[i].name.size(), file) == inputs[i].name.size();
+
+    // blobs follow the names, zero padded up to each aligned offset
+    static const unsigned char zeros[AssetPack::Alignment] = {};
+    size_t written = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (const InputFile& input : inputs)
+        written += input.name.size();
+    for (size_t i = 0; ok && i < inputs.size(); i++)
+    {
+        size_t padding = entries[i].offset - written;
+        ok = fwrite(zeros, 1, padding, file) == padding
+            && fwrite(inputs[i].data.data(), 1, inputs[i].data.size(), file) == inputs[i].data.size();
+        written = entries[i].offset + entries[i].size;
+    }
+    fclose(file);
+
+    if (!ok)
+    {
+        std::cout << "assetpack: failed to write " << output << std::endl;
+        return false;
+    }
+    std::cout << output << ": " << inputs.size() << " files, " << written << " bytes" << std::endl;
+    return true;
+}
+
+static bool verifyPack(const std::string& input)
+{
+    AssetPack pack;
+    if (!pack.open(input))
+    {
+        std::cout << "assetpack: " << input << " is missing or not a pack" << std::endl;
+        return false;
+    }
+
+    int failed = 0;
+    for (uint32_t i = 0; i < pack.entryCount(); i++)
+    {
+        const PackEntry& entry = pack.entry(i);
+        bool ok = pack.verify(entry);
+        std::cout << pack.name(entry) << ": " << entry.size << " bytes at " << entry.offset
+                  << (ok ? "" : ", HASH MISMATCH") << std::endl;
+        if (!ok)
+            failed++;
+    }
+    return failed == 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 3 && std::strcmp(argv[1], "--verify") == 0)
+        return verifyPack(argv[2]) ? 0 : 1;
+
+    if (argc < 3)
+    {
+        std::cout << "usage: assetpack output.pack file..." << std::endl;
+        std::cout << "       assetpack --verify input.pack" << std::endl;
+        return 1;
+    }
+
+    std::vector<InputFile> inputs;
+    for (int i = 2; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file)
+        {
+            std::cout << "assetpack: failed to read " << argv[i] << std::endl;
+            return 1;
+        }
+        InputFile input;
+        input.name = argv[i];
+        input.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        inputs.push_back(std::move(input));
+    }
+    return writePack(argv[1], inputs) ? 0 : 1;
+}
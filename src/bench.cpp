@@ -0,0 +1,430 @@
+// bench: microbenchmarks of the CPU paths the renderer runs at startup and every frame.
+// Sphere mesh generation at each SphereLOD tessellation, the Saturn ring mesh, the
+// camera's view matrix and direction update, the per-frame planet and orbit transforms,
+// and Shader uniform lookups and setters. The setters run against a stub GL handed to
+// glad's loader, so what is timed is the shader class's own work, not a driver.
+//
+// Each benchmark is calibrated to run for at least --min-time seconds, timed over
+// --repetitions runs, and reported as the median. --json writes the results in Google
+// Benchmark's JSON layout, so two runs can be compared with its tools/compare.py.
+//
+//   bench [--filter substring] [--min-time seconds] [--repetitions N] [--json file]
+//
+// Run from the repository root: the shader benchmarks read their sources from there.
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include "glad/glad.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Camera.h"
+#include "KeplerOrbit.h"
+#include "SceneGeometry.h"
+#include "SphereMesh.h"
+#include "JobSystem.h"
+#include "shader_s.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+// keeps the compiler from dropping work whose result is never used
+template <typename T>
+static inline void keep(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult
+{
+    std::string name;
+    long long iterations;
+    double nsPerIteration;
+};
+
+struct BenchOptions
+{
+    std::string filter;
+    double minTime = 0.2;
+    int repetitions = 5;
+    std::string jsonPath;
+};
+
+class BenchRunner
+{
+public:
+    explicit BenchRunner(const BenchOptions& options) : m_Options(options) {}
+
+    // body(iterations) runs the measured work that many times
+    void run(const std::string& name, const std::function<void(long long)>& body)
+    {
+        if (!m_Options.filter.empty() && name.find(m_Options.filter) == std::string::npos)
+            return;
+
+        // grow the batch until one takes minTime, then time the repetitions at that size
+        long long iterations = 1;
+        for (;;)
+        {
+            double seconds = time(body, iterations);
+            if (seconds >= m_Options.minTime || iterations >= (1ll << 40))
+                break;
+            double scale = seconds > 0.0 ? m_Options.minTime * 1.4 / seconds : 10.0;
+            iterations = (long long)((double)iterations * std::min(std::max(scale, 2.0), 100.0));
+        }
+        std::vector<double> samples;
+        for (int i = 0; i < m_Options.repetitions; i++)
+            samples.push_back(time(body, iterations) * 1e9 / (double)iterations);
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result = { name, iterations, samples[samples.size() / 2] };
+        m_Results.push_back(result);
+        std::cout << std::left << std::setw(48) << name << std::right << std::setw(14) << std::fixed << std::setprecision(1)
+                  << result.nsPerIteration << " ns" << std::setw(14) << iterations << std::endl;
+    }
+
+    bool writeJson() const
+    {
+        FILE* file = fopen(m_Options.jsonPath.c_str(), "w");
+        if (!file)
+        {
+            std::cout << "bench: failed to open " << m_Options.jsonPath << std::endl;
+            return false;
+        }
+
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        fprintf(file, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"executable\": \"bench\",\n    \"num_cpus\": %u,\n"
+            "    \"library_build_type\": \"%s\"\n  },\n  \"benchmarks\": [\n",
+            date, std::thread::hardware_concurrency(),
+#ifdef NDEBUG
+            "release"
+#else
+            "debug"
+#endif
+        );
+        for (size_t i = 0; i < m_Results.size(); i++)
+        {
+            const BenchResult& result = m_Results[i];
+            fprintf(file, "    {\n      \"name\": \"%s\",\n      \"run_name\": \"%s\",\n      \"run_type\": \"iteration\",\n"
+                "      \"iterations\": %lld,\n      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"\n    }%s\n",
+                result.name.c_str(), result.name.c_str(), result.iterations, result.nsPerIteration, result.nsPerIteration,
+                i + 1 < m_Results.size() ? "," : "");
+        }
+        fputs("  ]\n}\n", file);
+        fclose(file);
+        return true;
+    }
+
+private:
+    BenchOptions m_Options;
+    std::vector<BenchResult> m_Results;
+
+    static double time(const std::function<void(long long)>& body, long long iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Just enough of GL for Shader: every shader compiles and links, and each program
+// reports the same handful of active uniforms. Uploads only count themselves.
+namespace StubGL
+{
+    const char* const Uniforms[] = { "model", "normalMatrix", "lightColor", "objectColor", "ambient", "layer", "time", "ourTexture" };
+    const int UniformCount = sizeof(Uniforms) / sizeof(Uniforms[0]);
+    long long uploads = 0;
+
+    const GLubyte* APIENTRY getString(GLenum name) { return (const GLubyte*)(name == GL_VERSION ? "3.3.0 stub" : ""); }
+    // glad wants at least one extension
+    const GLubyte* APIENTRY getStringi(GLenum, GLuint) { return (const GLubyte*)"GL_stub"; }
+    void APIENTRY getIntegerv(GLenum name, GLint* data) { *data = name == GL_NUM_EXTENSIONS ? 1 : 0; }
+    GLuint APIENTRY createShader(GLenum) { return 1; }
+    void APIENTRY shaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {}
+    void APIENTRY compileShader(GLuint) {}
+    void APIENTRY getShaderiv(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+    void APIENTRY deleteShader(GLuint) {}
+    GLuint APIENTRY createProgram() { return 1; }
+    void APIENTRY attachShader(GLuint, GLuint) {}
+    void APIENTRY linkProgram(GLuint) {}
+    void APIENTRY useProgram(GLuint) {}
+    void APIENTRY getProgramiv(GLuint, GLenum name, GLint* params)
+    {
+        if (name == GL_ACTIVE_UNIFORMS)
+            *params = UniformCount;
+        else if (name == GL_ACTIVE_UNIFORM_MAX_LENGTH)
+            *params = 32;
+        else
+            *params = GL_TRUE;
+    }
+    void APIENTRY getActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei*, GLint* size, GLenum* type, GLchar* name)
+    {
+        *size = 1;
+        *type = GL_FLOAT;
+        std::snprintf(name, bufSize, "%s", Uniforms[index]);
+    }
+    GLint APIENTRY getUniformLocation(GLuint, const GLchar* name)
+    {
+        for (int i = 0; i < UniformCount; i++)
+        {
+            if (std::strcmp(Uniforms[i], name) == 0)
+                return i;
+        }
+        return -1;
+    }
+    GLuint APIENTRY getUniformBlockIndex(GLuint, const GLchar*) { return GL_INVALID_INDEX; }
+    void APIENTRY uniform1i(GLint, GLint) { uploads++; }
+    void APIENTRY uniform1f(GLint, GLfloat) { uploads++; }
+    void APIENTRY uniform3f(GLint, GLfloat, GLfloat, GLfloat) { uploads++; }
+    void APIENTRY uniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { uploads++; }
+
+    void* load(const char* name)
+    {
+        struct Entry
+        {
+            const char* name;
+            void* function;
+        };
+        static const Entry entries[] = {
+            { "glGetString", (void*)&getString },
+            { "glGetStringi", (void*)&getStringi },
+            { "glGetIntegerv", (void*)&getIntegerv },
+            { "glCreateShader", (void*)&createShader },
+            { "glShaderSource", (void*)&shaderSource },
+            { "glCompileShader", (void*)&compileShader },
+            { "glGetShaderiv", (void*)&getShaderiv },
+            { "glDeleteShader", (void*)&deleteShader },
+            { "glCreateProgram", (void*)&createProgram },
+            { "glAttachShader", (void*)&attachShader },
+            { "glLinkProgram", (void*)&linkProgram },
+            { "glUseProgram", (void*)&useProgram },
+            { "glGetProgramiv", (void*)&getProgramiv },
+            { "glGetActiveUniform", (void*)&getActiveUniform },
+            { "glGetUniformLocation", (void*)&getUniformLocation },
+            { "glGetUniformBlockIndex", (void*)&getUniformBlockIndex },
+            { "glUniform1i", (void*)&uniform1i },
+            { "glUniform1f", (void*)&uniform1f },
+            { "glUniform3f", (void*)&uniform3f },
+            { "glUniformMatrix4fv", (void*)&uniformMatrix4fv },
+        };
+        for (const Entry& entry : entries)
+        {
+            if (std::strcmp(entry.name, name) == 0)
+                return entry.function;
+        }
+        return nullptr;
+    }
+}
+
+static void benchMeshes(BenchRunner& runner)
+{
+    for (int level = 0; level < SphereLOD::Levels; level++)
+    {
+        int tessellation = SphereLOD::tessellation(level);
+        runner.run("SphereMesh::generate/" + std::to_string(tessellation), [tessellation](long long iterations) {
+            std::vector<float> vertices;
+            std::vector<unsigned int> indices;
+            for (long long i = 0; i < iterations; i++)
+            {
+                vertices.clear();
+                indices.clear();
+                SphereMesh::generate(tessellation, tessellation, vertices, indices);
+                keep(vertices.data());
+            }
+        });
+    }
+
+    for (int segments : { 100, 1000 })
+    {
+        runner.run("generateRingMesh/" + std::to_string(segments), [segments](long long iterations) {
+            std::vector<float> vertices;
+            for (long long i = 0; i < iterations; i++)
+            {
+                generateRingMesh(vertices, 9.36f * 0.3f, 9.36f * 0.5f, segments);
+                keep(vertices.data());
+            }
+        });
+    }
+}
+
+static void benchCamera(BenchRunner& runner)
+{
+    Camera camera(glm::dvec3(25.3380, 28.2700, 60.1150), glm::vec3(0.0f, 1.0f, 0.0f), -115.0f, -30.0f);
+
+    runner.run("Camera::GetViewMatrix", [&camera](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+        {
+            glm::mat4 view = camera.GetViewMatrix();
+            keep(view);
+        }
+    });
+    // updateCameraVectors is private; mouse movement is what calls it every frame
+    runner.run("Camera::ProcessMouseMovement", [&camera](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+        {
+            camera.ProcessMouseMovement((i & 1) ? 3.0f : -3.0f, (i & 2) ? 1.0f : -1.0f);
+            keep(camera.Front);
+        }
+    });
+}
+
+static void benchTransforms(BenchRunner& runner)
+{
+    // the same eight orbits main starts its planets on
+    const int planets = 8;
+    const double gm = 15.0;
+    const float rotationSpeed[planets] = { 0.11f, -0.026f, 5.28f, 5.12f, 12.20f, 11.16f, -7.75f, 8.36f };
+    const double distance[planets] = { 4.00, 5.60, 6.68, 7.94, 15.84, 25.76, 33.60, 40.63 };
+    std::vector<KeplerOrbit> orbits(planets);
+    std::vector<glm::dvec3> positions(planets);
+    std::vector<glm::dmat4> ellipses(planets);
+    for (int i = 0; i < planets; i++)
+    {
+        orbits[i].semiMajorAxis = distance[i] + 10.0;
+        orbits[i].eccentricity = 0.02 * (i + 1);
+        orbits[i].inclination = 0.01 * i;
+        orbits[i].meanAnomaly = 0.7 * i;
+        positions[i] = orbits[i].position(gm, 0.0);
+        ellipses[i] = orbits[i].ellipse();
+    }
+    Camera camera(glm::dvec3(25.3380, 28.2700, 60.1150), glm::vec3(0.0f, 1.0f, 0.0f), -115.0f, -30.0f);
+
+    // main's per-frame planet task: translate to the camera-relative position and spin
+    std::vector<glm::mat4> planetModels(planets);
+    runner.run("frame/planet transforms", [&](long long iterations) {
+        for (long long frame = 0; frame < iterations; frame++)
+        {
+            double currentFrame = frame * (1.0 / 60.0);
+            JobSystem::global().parallelFor(planets, 64, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    planetModels[i] = glm::translate(glm::mat4(1.0f), camera.Relative(positions[i]));
+                    planetModels[i] = glm::rotate(planetModels[i], spinAngle(currentFrame, rotationSpeed[i] / 10.0), glm::vec3(0.0f, 1.0f, 0.0f));
+                }
+            });
+            keep(planetModels[0]);
+        }
+    });
+
+    // the orbit ellipses, rebased on the camera in double before they become float
+    runner.run("frame/orbit transforms", [&](long long iterations) {
+        for (long long frame = 0; frame < iterations; frame++)
+        {
+            for (int i = 0; i < planets; i++)
+            {
+                glm::mat4 modelorb = glm::mat4(glm::translate(glm::dmat4(1.0), -camera.Position) * ellipses[i]);
+                keep(modelorb);
+            }
+        }
+    });
+
+    runner.run("frame/kepler positions", [&](long long iterations) {
+        for (long long frame = 0; frame < iterations; frame++)
+        {
+            double currentFrame = frame * (1.0 / 60.0);
+            for (int i = 0; i < planets; i++)
+                positions[i] = orbits[i].position(gm, currentFrame);
+            keep(positions[0]);
+        }
+    });
+}
+
+static void benchUniforms(BenchRunner& runner)
+{
+    if (!gladLoadGLLoader((GLADloadproc)StubGL::load))
+    {
+        std::cout << "bench: stub GL failed to load, skipping shader benchmarks" << std::endl;
+        return;
+    }
+
+    runner.run("Shader::Shader", [](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+        {
+            Shader shader("sphere_shader.vs", "sphere_shader.fs");
+            keep(shader.ID);
+        }
+    });
+
+    Shader shader("sphere_shader.vs", "sphere_shader.fs");
+    UniformHandle model = shader.uniform("model");
+    UniformHandle color = shader.uniform("lightColor");
+    UniformHandle layer = shader.uniform("layer");
+    const glm::mat4 matrices[2] = { glm::mat4(1.0f), glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)) };
+
+    runner.run("Shader::uniform", [&shader](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+        {
+            UniformHandle handle = shader.uniform("objectColor");
+            keep(handle);
+        }
+    });
+    runner.run("Shader::set mat4/changed", [&](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+            shader.set(model, matrices[i & 1]);
+    });
+    runner.run("Shader::set mat4/unchanged", [&](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+            shader.set(model, matrices[0]);
+    });
+    runner.run("Shader::set vec3/changed", [&](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+            shader.set(color, glm::vec3((float)(i & 1), 0.5f, 0.25f));
+    });
+    runner.run("Shader::set int/changed", [&](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+            shader.set(layer, (int)(i & 1));
+    });
+    // the by-name setters the older call sites still use: a string, a lookup and a set
+    runner.run("Shader::SetUniformMat4f", [&](long long iterations) {
+        for (long long i = 0; i < iterations; i++)
+            shader.SetUniformMat4f("model", matrices[i & 1]);
+    });
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue)
+            options.filter = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue)
+            options.minTime = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--repetitions") == 0 && hasValue)
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--json") == 0 && hasValue)
+            options.jsonPath = argv[++i];
+        else
+        {
+            std::cout << "usage: bench [--filter substring] [--min-time seconds] [--repetitions N] [--json file]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << std::left << std::setw(48) << "benchmark" << std::right << std::setw(17) << "time" << std::setw(14) << "iterations" << std::endl;
+    BenchRunner runner(options);
+    benchMeshes(runner);
+    benchCamera(runner);
+    benchTransforms(runner);
+    benchUniforms(runner);
+
+    if (!options.jsonPath.empty() && !runner.writeJson())
+        return 1;
+    return 0;
+}
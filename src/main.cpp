@@ -1,7 +1,15 @@
 #define GLM_ENABLE_EXPERIMENTAL
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "glad/glad.h"
@@ -15,19 +23,40 @@
 #include "KHR/khrplatform.h"
 
 #include "Sphere.h"
+#include "BodyRenderer.h"
+#include "AsteroidBelt.h"
+#include "FrameUBO.h"
+#include "AssetPack.h"
+#include "AssetLoader.h"
+#include "SkyboxSwitcher.h"
 #include "Camera.h"
+#include "FrameCapture.h"
+#include "FrustumCuller.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "JobSystem.h"
+#include "Simulation.h"
+#include "SimulationThread.h"
+#include "KeplerOrbit.h"
+#include "SceneGeometry.h"
+#include "CameraPath.h"
+#include "GLStats.h"
+#include "PerfReport.h"
+#ifdef SOLAR_HEADLESS
+#include "HeadlessContext.h"
+#endif
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window, float deltaTime);
-unsigned int loadCubemap(std::vector<std::string> faces);
-unsigned int loadTexture(char const * path);
-void generateRingMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices, float innerRadius, float outerRadius, int segments);
+unsigned int loadTexture(char const * path, AssetLoader& loader);
 
 int SCR_WIDTH = 800;
 int SCR_HEIGHT = 600;
 const unsigned int noOfPlanets = 8;
-bool SkyBoxExtra = false;
 std::unique_ptr<Camera> camera = std::unique_ptr<Camera>();
+std::unique_ptr<SkyboxSwitcher> skybox = std::unique_ptr<SkyboxSwitcher>();
+bool showProfiler = false;
+std::string tracePath = "trace.json";
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
@@ -51,36 +80,199 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos)
     camera->ProcessMouseMovement(xoffset, yoffset);
 }
 
+void key_callback(GLFWwindow*, int key, int, int action, int)
+{
+    if (key == GLFW_KEY_B && action == GLFW_PRESS)
+        skybox->next();
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+        showProfiler = !showProfiler;
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+        Trace::write(tracePath);
+}
+
+// command line: `main` opens a window; `main --headless` renders a fixed number of frames
+// offscreen, advancing time by a fixed step. Either way --out captures every frame to
+// <out>/frame_NNNNN.png and --pipe streams raw yuv420p video into an encoder, e.g.
+//   --pipe "ffmpeg -f rawvideo -pix_fmt yuv420p -s 800x600 -r 60 -i - clip.mp4"
+// --asteroids sets how many rocks make up the belt between Mars and Jupiter.
+// --profile-csv writes every frame's CPU and GPU time per pass to a file, and --overlay
+// starts with the profiler graph showing (P toggles it). --trace writes a Chrome trace of
+// every thread to a file on exit; T writes one at any time, to trace.json if not given.
+// --scene flies the camera along a CameraPath script; headless, the frames are spread
+// evenly over its time range. --perf-report writes frame time percentiles, GL counts and
+// peak memory for the run, and --perf-baseline compares them against a checked-in report
+// and exits non-zero on a regression (see the perfcheck target). --source-assets ignores
+// assets.pack and baked .dds files and loads the shaders and images tracked in git.
+struct RunOptions
+{
+    bool headless = false;
+    int frames = 300;
+    double step = 1.0 / 60.0;
+    int asteroids = 20000;
+    std::string outDir;
+    std::string pipeCommand;
+    std::string profileCsv;
+    bool overlay = false;
+    bool trace = false;
+    std::string scene;
+    std::string perfReport;
+    std::string perfBaseline;
+    bool sourceAssets = false;
+};
+
+bool parseOptions(int argc, char** argv, RunOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--headless") == 0)
+            options.headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            options.frames = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--step") == 0 && hasValue)
+            options.step = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--size") == 0 && hasValue && std::sscanf(argv[i + 1], "%dx%d", &SCR_WIDTH, &SCR_HEIGHT) == 2)
+            i++;
+        else if (std::strcmp(argv[i], "--out") == 0 && hasValue)
+            options.outDir = argv[++i];
+        else if (std::strcmp(argv[i], "--pipe") == 0 && hasValue)
+            options.pipeCommand = argv[++i];
+        else if (std::strcmp(argv[i], "--asteroids") == 0 && hasValue)
+            options.asteroids = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--profile-csv") == 0 && hasValue)
+            options.profileCsv = argv[++i];
+        else if (std::strcmp(argv[i], "--overlay") == 0)
+            options.overlay = true;
+        else if (std::strcmp(argv[i], "--trace") == 0 && hasValue)
+        {
+            tracePath = argv[++i];
+            options.trace = true;
+        }
+        else if (std::strcmp(argv[i], "--scene") == 0 && hasValue)
+            options.scene = argv[++i];
+        else if (std::strcmp(argv[i], "--perf-report") == 0 && hasValue)
+            options.perfReport = argv[++i];
+        else if (std::strcmp(argv[i], "--perf-baseline") == 0 && hasValue)
+            options.perfBaseline = argv[++i];
+        else if (std::strcmp(argv[i], "--source-assets") == 0)
+            options.sourceAssets = true;
+        else
+        {
+            std::cout << "usage: main [--headless] [--frames N] [--step seconds] [--size WxH] [--out dir | --pipe command] [--asteroids N] [--profile-csv file] [--overlay] [--trace file] [--scene file] [--perf-report file] [--perf-baseline file] [--source-assets]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int main(int argc, char** argv) {
+
+Trace::setThreadName("main");
+Trace::begin("startup");
 
-int main() {
+RunOptions options;
+if (!parseOptions(argc, argv, options))
+    return -1;
 
 std::vector<float> size = {0.38f, 0.87f, 1.00f, 0.53f, 12.54f, 9.36f, 4.04f, 3.84f, 0.3f};
 std::vector<float> distance = {4.00f, 5.60f, 6.68f, 7.94f, 15.84f, 25.76f, 33.60f, 40.63f, 0.13f};
 std::vector<float> speed = {0.1f, 0.084f, 0.057f, 0.034f, 0.014f, 0.0093f, 0.0049f, 0.0027f, 0.2f};
 std::vector<float> rotationSpeed = {0.11f, -0.026f, 5.28f, 5.12f, 12.20f, 11.16f, -7.75f, 8.36f, 0.23f};
+// in solar masses
+std::vector<double> mass = {1.66e-7, 2.45e-6, 3.00e-6, 3.23e-7, 9.55e-4, 2.86e-4, 4.37e-5, 5.15e-5, 3.69e-8};
+// J2000 orbital elements, angles in degrees; the semi-major axes stay the scene's compressed distances
+std::vector<double> eccentricity = {0.2056, 0.0068, 0.0167, 0.0934, 0.0484, 0.0542, 0.0472, 0.0086, 0.0549};
+std::vector<double> inclination = {7.005, 3.395, 0.0, 1.850, 1.303, 2.485, 0.773, 1.770, 5.145};
+std::vector<double> ascendingNode = {48.331, 76.680, 0.0, 49.558, 100.464, 113.665, 74.006, 131.784, 125.08};
+std::vector<double> perihelion = {77.456, 131.533, 102.947, 336.041, 14.331, 93.057, 173.005, 48.124, 83.23};
+std::vector<double> meanLongitude = {252.251, 181.980, 100.464, 355.453, 34.351, 50.077, 314.055, 304.349, 218.316};
 std::vector<std::string> textures = {"sun.jpg", "mercury.jpg", "venus.jpg", "earth.jpg", "mars.jpg", "jupiter.jpg", "saturn.jpg", "uranus.jpg", "neptune.jpg" , "moon.jpg"};
-
-glfwInit();
-glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "The Sun", NULL, NULL);
-if (window == NULL)
+std::vector<std::string> faces {
+    "include/skybox/starfield/starfield_rt.tga",
+    "include/skybox/starfield/starfield_lf.tga",
+    "include/skybox/starfield/starfield_up.tga",
+    "include/skybox/starfield/starfield_dn.tga",
+    "include/skybox/starfield/starfield_ft.tga",
+    "include/skybox/starfield/starfield_bk.tga",
+};
+std::vector<std::string> faces_extra {
+    "include/skybox/blue/bkg1_right.png",
+    "include/skybox/blue/bkg1_left.png",
+    "include/skybox/blue/bkg1_top.png",
+    "include/skybox/blue/bkg1_bot.png",
+    "include/skybox/blue/bkg1_front.png",
+    "include/skybox/blue/bkg1_back.png",
+};
+const int layerWidth = 2048;
+const int layerHeight = 1024;
+
+// shaders and baked textures come out of the mapped pack when `pack_assets` has built one
+if (!options.sourceAssets && AssetPack::mounted().open("assets.pack"))
+    std::cout << "Mounted assets.pack (" << AssetPack::mounted().entryCount() << " files)" << std::endl;
+
+// decode every image on worker threads while the window and GL context are being created
+AssetLoader loader(!options.sourceAssets);
+loader.prefetch(textures[0], 3);
+for (size_t i = 1; i < textures.size(); i++)
+    loader.prefetch(textures[i], 3, layerWidth, layerHeight);
+loader.prefetch("ring.jpg", 0);
+for (const std::string& face : faces)
+    loader.prefetch(face, 3);
+
+
+GLFWwindow* window = NULL;
+#ifdef SOLAR_HEADLESS
+HeadlessContext headless;
+#endif
+if (options.headless)
 {
-    std::cout << "Failed to create GLFW window" << std::endl;
-    glfwTerminate();
+#ifdef SOLAR_HEADLESS
+    if (!headless.create(SCR_WIDTH, SCR_HEIGHT))
+        return -1;
+#else
+    std::cout << "This build has no headless support; configure with -DHEADLESS=ON" << std::endl;
     return -1;
+#endif
 }
-glfwMakeContextCurrent(window);
-glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-
-if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+else
 {
-    std::cout << "Failed to initialize GLAD" << std::endl;
-    return -1;
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "The Sun", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
 }
 
+// measured runs count their GL calls; everything else talks to the driver directly,
+// unless built with GL_INTERCEPT, which counts every run and shows the calls in the overlay
+const bool measured = !options.perfReport.empty() || !options.perfBaseline.empty();
+#ifdef SOLAR_GL_INTERCEPT
+const bool interceptGL = true;
+#else
+const bool interceptGL = false;
+#endif
+if (measured || interceptGL)
+    GLStats::install();
+
+// S3TC is an extension, not core 3.3
+loader.checkCompressedTextures();
+
 glEnable(GL_DEPTH_TEST);
 
 float skyboxVertices[] = {
@@ -160,8 +352,7 @@ glBindBuffer(GL_ARRAY_BUFFER, 0);
 glBindVertexArray(0);
 
 std::vector<float> ringVertices;
-std::vector<unsigned int> ringIndices;
-generateRingMesh(ringVertices, ringIndices, size[5] * 0.3, size[5] * 0.5f, 100);
+generateRingMesh(ringVertices, size[5] * 0.3, size[5] * 0.5f, 100);
 GLuint ringVAO, ringVBO;
 glGenVertexArrays(1, &ringVAO);
 glGenBuffers(1, &ringVBO);
@@ -173,176 +364,375 @@ glEnableVertexAttribArray(0);
 glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
 glEnableVertexAttribArray(1);
 glBindVertexArray(0);
-unsigned int ring_texture = loadTexture("ring.jpg");
+unsigned int ring_texture = loadTexture("ring.jpg", loader);
 Shader ringShader("ring_vs.vs", "ring_fs.fs");
 
 
 glm::mat4 model = glm::mat4(1.0f);
 
 glm::mat4 projection = glm::mat4(1.0f);
-projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 1000.0f);
+projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
 
 glm::mat4 view = glm::mat4(1.0f);
 view = glm::translate(view, glm::vec3(0.0f, -1.0f, -10.0f));
 
-Sphere sun = Sphere(0.1f * 100.0f, "sphere_shader.vs", "sphere_shader.fs", model, view, projection, textures[0]);
-std::vector<Sphere> planets;
-Sphere moon = Sphere(0.1f * size[8] , "3.3.shader.vs", "3.3.shader.fs", model, view, projection, textures[9]);
+const float sunRadius = 0.1f * 100.0f;
+Sphere sun = Sphere(sunRadius, "sphere_shader.vs", "sphere_shader.fs", model, view, projection, textures[0], loader);
 
-for(int i = 0; i < noOfPlanets; i++)
-    planets.emplace_back(Sphere(0.25 * size[i], "3.3.shader.vs", "3.3.shader.fs", model, view, projection, textures[i + 1]));
+// planets take texture layers 0-7 and the moon layer 8
+std::vector<std::string> bodyTextures(textures.begin() + 1, textures.end());
+BodyRenderer bodies("instanced_shader.vs", "instanced_shader.fs", bodyTextures, loader, layerWidth, layerHeight);
+sun.setProjection(projection, SCR_HEIGHT);
+bodies.setProjection(projection, SCR_HEIGHT);
+
+FrameUBO frameUBO;
 
 Shader SkyboxShader("skybox.vs", "skybox.fs");
 Shader SimpleShader("orbit_vs.vs", "orbit_fs.fs");
+UniformHandle orbitModelUniform = SimpleShader.uniform("model");
 
-std::vector<std::string> faces {
-    "include/skybox/starfield/starfield_rt.tga",
-    "include/skybox/starfield/starfield_lf.tga",
-    "include/skybox/starfield/starfield_up.tga",
-    "include/skybox/starfield/starfield_dn.tga",
-    "include/skybox/starfield/starfield_ft.tga",
-    "include/skybox/starfield/starfield_bk.tga",
-};
-std::vector<std::string> faces_extra {
-    "include/skybox/blue/bkg1_right.png",
-    "include/skybox/blue/bkg1_left.png",
-    "include/skybox/blue/bkg1_top.png",
-    "include/skybox/blue/bkg1_bot.png",
-    "include/skybox/blue/bkg1_front.png",
-    "include/skybox/blue/bkg1_back.png",
-};
+// only the starfield is loaded up front; B switches skyboxes and loads the others on first use
+skybox = std::make_unique<SkyboxSwitcher>(loader, 60.0);
+skybox->show(skybox->add(faces));
+skybox->add(faces_extra);
 
-unsigned int cubemapTexture = loadCubemap(faces);
-unsigned int cubemapTextureExtra = loadCubemap(faces_extra);
+loader.finish();
 
-camera = std::make_unique<Camera>(glm::vec3(25.3380f, 28.2700f, 60.1150f), glm::vec3(0.0f, 1.0f, 0.0f), -115.0f, -30.0f);
+camera = std::make_unique<Camera>(glm::dvec3(25.3380, 28.2700, 60.1150), glm::vec3(0.0f, 1.0f, 0.0f), -115.0f, -30.0f);
 camera->MovementSpeed = 5.0f;
 
-glfwSetCursorPosCallback(window, mouse_callback);
-glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+if (window)
+{
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+}
+
+// reads the frame back asynchronously; encoding happens on worker threads
+std::unique_ptr<FrameCapture> capture;
+if (!options.pipeCommand.empty())
+{
+    capture = std::make_unique<FrameCapture>(SCR_WIDTH, SCR_HEIGHT);
+    if (!capture->openPipe(options.pipeCommand))
+        return -1;
+}
+else if (!options.outDir.empty())
+{
+    std::filesystem::create_directories(options.outDir);
+    capture = std::make_unique<FrameCapture>(SCR_WIDTH, SCR_HEIGHT);
+    capture->openDirectory(options.outDir);
+}
+
+// planets 0-7 orbit the sun, index 8 is the moon around Earth
+std::vector<KeplerOrbit> orbits(noOfPlanets + 1);
+for (unsigned int i = 0; i <= noOfPlanets; i++)
+{
+    KeplerOrbit& orbit = orbits[i];
+    orbit.semiMajorAxis = i < noOfPlanets ? distance[i] + 10.0 : distance[8] + 0.2;
+    orbit.eccentricity = eccentricity[i];
+    orbit.inclination = glm::radians(inclination[i]);
+    orbit.ascendingNode = glm::radians(ascendingNode[i]);
+    orbit.argumentOfPeriapsis = glm::radians(perihelion[i] - ascendingNode[i]);
+    orbit.meanAnomaly = glm::radians(meanLongitude[i] - perihelion[i]);
+}
+
+// the orbits themselves never change; only the camera offset does
+std::vector<glm::dmat4> orbitEllipses;
+for (unsigned int i = 0; i < noOfPlanets; i++)
+    orbitEllipses.push_back(orbits[i].ellipse());
+
+// the sun and planets move under their mutual gravity, starting from their Kepler orbits.
+// G*M of the sun is chosen so Earth keeps the period of the old fixed circles.
+// The moon's orbit is far outside Earth's Hill sphere at this scene scale, so it
+// stays a kinematic satellite of wherever Earth is, on its own Kepler orbit at the
+// old angular rate.
+const double sunGM = 15.0;
+const double moonGM = speed[8] * speed[8] * std::pow(orbits[8].semiMajorAxis, 3.0);
+
+// bodies on fixed Kepler orbits around a simulated one rather than in the simulation,
+// solved together each frame by the batched solver; for now that is only the moon
+KeplerOrbitSet satellites;
+std::vector<size_t> satelliteParents;
+satellites.add(orbits[8], moonGM);
+satelliteParents.push_back(3);
+const size_t moonSatellite = 0;
+std::vector<double> satelliteX(satellites.size()), satelliteY(satellites.size()), satelliteZ(satellites.size());
+
+// the belt keeps clear of Mars and Jupiter; its rocks feel only the sun and never enter the simulation
+AsteroidBelt belt("asteroid_shader.vs", "asteroid_shader.fs", (size_t)options.asteroids, sunGM,
+    orbits[3].semiMajorAxis + 1.5, orbits[4].semiMajorAxis - 3.0, 0.06f);
+Simulation simulation;
+simulation.addBody(sunGM, glm::dvec3(0.0), glm::dvec3(0.0));
+for (unsigned int i = 0; i < noOfPlanets; i++)
+{
+    glm::dvec3 position, velocity;
+    orbits[i].state(sunGM * (1.0 + mass[i]), 0.0, position, velocity);
+    simulation.addBody(sunGM * mass[i], position, velocity);
+}
+simulation.removeNetMomentum();
+
+// windowed, the simulation steps in real time on its own thread; headless runs step it
+// from the render loop instead, so their frames do not depend on thread timing
+SimulationThread simThread(std::move(simulation));
+if (window)
+    simThread.start([]() { return glfwGetTime(); });
+std::vector<glm::dvec3> bodyPositions;
 
 float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+double currentFrame = 0.0;
+double lastFrame = 0.0;
 float sunRotationSpeed = 0.2476f;
+int frameIndex = 0;
+
+// per-frame CPU work as a task graph on the job system: bring the simulation up to the
+// frame's time and solve the satellites' orbits, take the simulation's positions, then
+// build every body's transform in parallel
+std::vector<glm::mat4> planetModels(noOfPlanets);
+glm::mat4 moonModel, ringModel;
+TaskGraph frameUpdate;
+TaskGraph::Task stepTask = frameUpdate.add([&]() {
+    if (!window)
+        simThread.stepTo(currentFrame);
+});
+TaskGraph::Task sampleTask = frameUpdate.add([&]() { simThread.sample(currentFrame, bodyPositions); });
+TaskGraph::Task planetTask = frameUpdate.add([&]() {
+    JobSystem::global().parallelFor(noOfPlanets, 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            planetModels[i] = glm::translate(glm::mat4(1.0f), camera->Relative(bodyPositions[i + 1]));
+            planetModels[i] = glm::rotate(planetModels[i], spinAngle(currentFrame, rotationSpeed[i] / 10.0), glm::vec3(0.0f, 1.0f, 0.0f));
+        }
+    });
+});
+TaskGraph::Task satelliteTask = frameUpdate.add([&]() {
+    satellites.positions(currentFrame, satelliteX.data(), satelliteY.data(), satelliteZ.data());
+});
+TaskGraph::Task moonTask = frameUpdate.add([&]() {
+    glm::dvec3 moonOffset(satelliteX[moonSatellite], satelliteY[moonSatellite], satelliteZ[moonSatellite]);
+    glm::vec3 moonTransform = camera->Relative(bodyPositions[satelliteParents[moonSatellite]] + moonOffset);
+    moonModel = glm::translate(glm::mat4(1.0f), moonTransform);
+    moonModel = glm::rotate(moonModel, spinAngle(currentFrame, rotationSpeed[8]), glm::vec3(0.0f, 1.0f, 0.0f));
+});
+TaskGraph::Task ringTask = frameUpdate.add([&]() {
+    ringModel = glm::translate(glm::mat4(1.0f), camera->Relative(bodyPositions[6]));
+    ringModel = glm::rotate(ringModel, glm::radians(20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+});
+frameUpdate.precede(stepTask, sampleTask);
+frameUpdate.precede(sampleTask, planetTask);
+frameUpdate.precede(sampleTask, moonTask);
+frameUpdate.precede(satelliteTask, moonTask);
+frameUpdate.precede(sampleTask, ringTask);
+
+// every frame, one bounding sphere per thing drawn, camera-relative like the geometry;
+// only what the frustum test keeps gets drawn
+FrustumCuller culler;
+
+// the planets zone also covers the moon, which is drawn in the same instanced batch
+Profiler profiler;
+const int updateZone = profiler.zone("update", false);
+const int cullZone = profiler.zone("cull", false);
+const int planetsZone = profiler.zone("planets", true);
+const int asteroidsZone = profiler.zone("asteroids", true);
+const int sunZone = profiler.zone("sun", true);
+const int orbitsZone = profiler.zone("orbits", true);
+const int ringZone = profiler.zone("ring", true);
+const int skyboxZone = profiler.zone("skybox", true);
+if (!options.profileCsv.empty() && !profiler.openCsv(options.profileCsv))
+    return -1;
+showProfiler = options.overlay;
 
+CameraPath scene;
+if (!options.scene.empty() && !scene.load(options.scene))
+    return -1;
+double sceneStep = options.step;
+if (!scene.empty() && options.frames > 1)
+    sceneStep = (scene.endTime() - scene.startTime()) / (options.frames - 1);
+PerfReport perf;
+Trace::end();
 
-while (!glfwWindowShouldClose(window))
+while (window ? !glfwWindowShouldClose(window) : frameIndex < options.frames)
 {
-    processInput(window, deltaTime);
+    if (window)
+        processInput(window, deltaTime);
+    if (measured)
+        perf.beginFrame();
+    profiler.beginFrame();
 
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    float currentFrame = static_cast<float>(glfwGetTime());
-    deltaTime = currentFrame - lastFrame;
+    // headless runs step simulated time so every run renders the same frames
+    // time stays double: as a float it would lose the milliseconds within a few hours of uptime
+    currentFrame = window ? glfwGetTime() : frameIndex * options.step;
+    if (!scene.empty())
+    {
+        if (!window)
+            currentFrame = scene.startTime() + frameIndex * sceneStep;
+        CameraPath::Key key = scene.sample(currentFrame);
+        camera->SetView(key.position, key.yaw, key.pitch);
+    }
+    deltaTime = static_cast<float>(currentFrame - lastFrame);
     lastFrame = currentFrame;
 
-    glm::mat4 view = camera->GetViewMatrix();
-
-    glm::vec3 lightPos = glm::vec3(sun.model[3]);
-    float t = currentFrame;
-    for(int i = 0; i < noOfPlanets; i++){
-
-        planets[i].model = glm::mat4(1.0f);
-        glm::vec3 modelTransform = glm::vec3(cosf(t * speed[i]) * (distance[i] + 10.0f), 0.0f, sinf(t * speed[i]) * (distance[i] + 10.0f));
-        planets[i].model = glm::translate(glm::mat4(1.0f), modelTransform);
+    profiler.begin(updateZone);
+    loader.poll();
+    skybox->update(currentFrame);
 
-        if(i == 2){
-            moon.model = planets[i].model;
-            glm::vec3 moonTransform = glm::vec3(cosf(t * speed[8]) * (distance[8] + 0.2f), 0.0f, sinf(t * speed[8]) * (distance[8] + 0.2f));
-            moon.model = glm::translate(moon.model, moonTransform);
+    frameUpdate.run(JobSystem::global());
+    profiler.end(updateZone);
+    // everything below is placed relative to the camera, which sits at the origin of the float data
+    const glm::dvec3 eye = camera->Position;
+    sun.model[3] = glm::vec4(camera->Relative(bodyPositions[0]), 1.0f);
 
-            moon.model = glm::rotate(moon.model, t * (rotationSpeed[8]), glm::vec3(0.0f, 1.0f, 0.0f));
-        }
-
-        planets[i].model = glm::rotate(planets[i].model, t * (rotationSpeed[i] / 10), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 view = camera->GetViewMatrix();
 
-        planets[i].m_Shader.use();
-        planets[i].m_Shader.SetUniformVec3f("lightPos", lightPos);
-        planets[i].m_Shader.SetUniformMat4f("view", view);
-        planets[i].m_Shader.SetUniformVec3f("viewPos", view[3]);
+    glm::vec3 lightPos = glm::vec3(sun.model[3]);
 
-        planets[i].render();
+    FrameData frame;
+    frame.view = view;
+    frame.projection = projection;
+    frame.lightPos = glm::vec4(lightPos, 1.0f);
+    frame.viewPos = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    frameUBO.update(frame);
+
+    // planets first, so their sphere index is their layer; an orbit's ellipse fits inside
+    // the circle of its semi-major axis around its centre
+    profiler.begin(cullZone);
+    culler.clear();
+    for (unsigned int i = 0; i < noOfPlanets; i++)
+        culler.add(glm::vec3(planetModels[i][3]), 0.25f * size[i]);
+    const size_t moonSphere = culler.add(glm::vec3(moonModel[3]), 0.1f * size[8]);
+    const size_t sunSphere = culler.add(glm::vec3(sun.model[3]), sunRadius);
+    const size_t beltSphere = culler.add(glm::vec3(sun.model[3]), belt.boundingRadius());
+    const size_t ringSphere = culler.add(glm::vec3(ringModel[3]), size[5] * 0.5f);
+    const size_t firstOrbit = culler.size();
+    for (unsigned int i = 0; i < noOfPlanets; i++)
+        culler.add(camera->Relative(glm::dvec3(orbitEllipses[i][3])), (float)orbits[i].semiMajorAxis);
+    const size_t sunCircle = culler.add(camera->Relative(glm::dvec3(0.0)), 0.5f * 1.3f);
+    culler.cull(projection * view);
+    profiler.end(cullZone);
+
+    double t = currentFrame;
+    bodies.clear();
+    for (uint32_t index : culler.visible())
+    {
+        if (index < noOfPlanets)
+            bodies.add(planetModels[index], 0.25f * size[index], index, index);
+        else if (index == moonSphere)
+            bodies.add(moonModel, 0.1f * size[8], noOfPlanets, noOfPlanets);
     }
 
-    moon.m_Shader.use();
-    moon.m_Shader.SetUniformVec3f("lightPos", lightPos);
-    moon.m_Shader.SetUniformMat4f("view", view);
-    moon.m_Shader.SetUniformVec3f("viewPos", view[3]);
-    moon.render();
+    {
+        ProfileZone zone(profiler, planetsZone);
+        bodies.render();
+    }
+    if (culler.isVisible(beltSphere))
+    {
+        ProfileZone zone(profiler, asteroidsZone);
+        belt.render(glm::vec3(sun.model[3]), t);
+    }
 
-    sun.model = glm::rotate(sun.model, t * (sunRotationSpeed / 6000.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    sun.model = glm::rotate(sun.model, spinAngle(t, sunRotationSpeed / 6000.0), glm::vec3(0.0f, 1.0f, 0.0f));
 
-    sun.m_Shader.use();
-    sun.m_Shader.SetUniformMat4f("view", view);
-    sun.render();
+    if (culler.isVisible(sunSphere))
+    {
+        ProfileZone zone(profiler, sunZone);
+        sun.render();
+    }
 
+    profiler.begin(orbitsZone);
     glBindVertexArray(VAO_t);
     glLineWidth(1.0f);
     SimpleShader.use();
-    SimpleShader.SetUniformMat4f("view", view);
-    SimpleShader.SetUniformMat4f("projection", projection);
     glm::mat4 modelorb;
     
-    for (int i = 0; i < noOfPlanets; i++)
+    for (uint32_t index : culler.visible())
     {
-        float orbitRadius = distance[i] + 10.0f;
-        modelorb = glm::mat4(1);
-        modelorb = glm::scale(modelorb, glm::vec3(orbitRadius, orbitRadius, orbitRadius));
-        SimpleShader.SetUniformMat4f("model", modelorb);
+        if (index < firstOrbit || index > sunCircle)
+            continue;
+        if (index < sunCircle)
+        {
+            modelorb = glm::mat4(glm::translate(glm::dmat4(1.0), -eye) * orbitEllipses[index - firstOrbit]);
+        }
+        else
+        {
+            modelorb = glm::mat4(1);
+            modelorb = glm::rotate(modelorb, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+            modelorb = glm::rotate(modelorb, glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+            modelorb = glm::translate(modelorb, camera->Relative(glm::dvec3(0.0)));
+            modelorb = glm::scale(modelorb, glm::vec3(0.5f *1.3f , 0.5f *1.3f, 0.5f *1.3f));
+        }
+        SimpleShader.set(orbitModelUniform, modelorb);
         glDrawArrays(GL_LINE_LOOP, 0, (GLsizei)orbitVertices.size() / 3);
     }
-    modelorb = glm::mat4(1);
-    modelorb = glm::rotate(modelorb, glm::radians(0.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-    modelorb = glm::rotate(modelorb, glm::radians(0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    modelorb = glm::translate(modelorb, glm::vec3(0.0f, 0.0f, 0.0f));
-    modelorb = glm::scale(modelorb, glm::vec3(0.5f *1.3f , 0.5f *1.3f, 0.5f *1.3f));
-    SimpleShader.SetUniformMat4f("model", modelorb);
-    glDrawArrays(GL_LINE_LOOP, 0, (GLsizei)orbitVertices.size() / 3);
-
-    ringShader.use();
-    ringShader.SetUniformMat4f("view", view);
-    ringShader.SetUniformMat4f("projection", projection);
-
-    glm::mat4 ringModel = glm::mat4(1.0f);
-    glm::vec3 saturnPos = glm::vec3(
-        cosf(t * speed[5]) * (distance[5] + 10.0f),
-        0.0f,
-        sinf(t * speed[5]) * (distance[5] + 10.0f)
-    );
-    ringModel = glm::translate(ringModel, saturnPos);
-    ringModel = glm::rotate(ringModel, glm::radians(20.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ringShader.SetUniformMat4f("model", ringModel);
+    profiler.end(orbitsZone);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, ring_texture);
+    if (culler.isVisible(ringSphere))
+    {
+        ProfileZone zone(profiler, ringZone);
+        ringShader.use();
 
-    glBindVertexArray(ringVAO);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, (102 + 1) * 2);
-    glBindVertexArray(0);
+        ringShader.SetUniformMat4f("model", ringModel);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, ring_texture);
+
+        glBindVertexArray(ringVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, (102 + 1) * 2);
+        glBindVertexArray(0);
+    }
 
     
+    profiler.begin(skyboxZone);
     glDepthFunc(GL_LEQUAL);  
     SkyboxShader.use();
-    view = glm::mat4(glm::mat3(camera->GetViewMatrix()));
-    SkyboxShader.SetUniformMat4f("view", view);
-    SkyboxShader.SetUniformMat4f("projection", projection);
     glBindVertexArray(skyboxVAO);
     glActiveTexture(GL_TEXTURE0);
-    if (SkyBoxExtra)
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTextureExtra);
-    else
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, skybox->texture());
     glDrawArrays(GL_TRIANGLES, 0, 36);
     glBindVertexArray(0);
     glDepthFunc(GL_LESS);  
+    profiler.end(skyboxZone);
+
+    if (showProfiler)
+        profiler.drawOverlay(SCR_WIDTH, SCR_HEIGHT, interceptGL ? GLStats::frameLines() : std::vector<std::string>());
     
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+    if (capture)
+        capture->capture();
+
+    if (window)
+    {
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+    profiler.endFrame();
+    if (measured)
+    {
+        // so the frame time includes the GPU's share of the frame
+        glFinish();
+        perf.endFrame();
+    }
+    if (interceptGL)
+        GLStats::endFrame();
+    frameIndex++;
 }
 
-glfwTerminate();
-return 0;
+simThread.stop();
+profiler.finish();
+if (interceptGL)
+    GLStats::printAverages();
+if (capture)
+    capture->finish();
+if (options.trace)
+    Trace::write(tracePath);
+bool regressed = false;
+if (!options.perfReport.empty())
+    perf.write(options.perfReport);
+if (!options.perfBaseline.empty())
+    regressed = !perf.compare(options.perfBaseline);
+if (window)
+    glfwTerminate();
+return regressed ? 1 : 0;
 }
 
 void processInput(GLFWwindow *window, float deltaTime)
@@ -366,96 +756,29 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
-unsigned int loadCubemap(std::vector<std::string> faces)
-{
-	unsigned int textureID;
-	glGenTextures(1, &textureID);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-	int width, height, nrChannels;
-
-	for (unsigned int i = 0; i < faces.size(); i++)
-	{
-		unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-
-		if (data)
-		{
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-				0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
-			);
-			stbi_image_free(data);
-		}
-		else
-		{
-			std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-			stbi_image_free(data);
-		}
-	}
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-	return textureID;
-}
-
-unsigned int loadTexture(char const * path)
+unsigned int loadTexture(char const * path, AssetLoader& loader)
 {
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
-    if (data)
-    {
-        GLenum format = GL_RGB;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-        else
-            std::cout << "Unexpected nrComponents: " << nrComponents << std::endl;
+    loader.load(path, 0, [textureID](const DecodedImage& image, const void* pixels) {
+        if (!image.pixels)
+        {
+            std::cout << "Texture failed to load at path: " << image.path << std::endl;
+            return;
+        }
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        AssetLoader::texImage2D(GL_TEXTURE_2D, image, pixels);
+        // baked textures carry a precomputed mip chain
+        if (image.levels == 1)
+            glGenerateMipmap(GL_TEXTURE_2D);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		stbi_image_free(data);
-	}
-	else
-	{
-		std::cout << "Texture failed to load at path: " << path << std::endl;
-		stbi_image_free(data);
-        return 0;
-	}
+    });
 
 	return textureID;
 }
-
-void generateRingMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices, float innerRadius, float outerRadius, int segments){
-    for (int i = 0; i <= segments; ++i) {
-        float theta = 2.0f * M_PI * float(i) / float(segments);
-        float x = cos(theta);
-        float z = sin(theta);
-
-        vertices.push_back(outerRadius * x);
-        vertices.push_back(0.0f);
-        vertices.push_back(outerRadius * z);
-        vertices.push_back(1.0f);
-        vertices.push_back(float(i) / segments);
-
-        vertices.push_back(innerRadius * x);
-        vertices.push_back(0.0f);
-        vertices.push_back(innerRadius * z);
-        vertices.push_back(0.0f);
-        vertices.push_back(float(i) / segments);
-    }
-}
\ No newline at end of file
@@ -0,0 +1,292 @@
+// nbody_bench: throughput and accuracy of the direct-summation gravity kernels.
+// For each body count, runs every kernel this CPU supports on the same random
+// cluster and reports pairwise interactions per second and the largest
+// relative deviation from the scalar kernel.
+// With --barnes-hut, builds the octree for each body count and walks it at a
+// range of opening angles instead, reporting build and walk times and the median
+// and 99th percentile error against direct summation on a sample of bodies.
+// With --kepler, propagates random elliptic orbits with the batched solver and
+// one at a time, and reports both times and the largest position difference.
+// With --cull, tests random bounding spheres against a camera frustum with the
+// scalar and AVX culls, and reports time per sphere and whether both kept the same ones.
+//
+//   nbody_bench [N...]                 (default 1000 2000 5000)
+//   nbody_bench --barnes-hut [N...]    (default 100000 1000000)
+//   nbody_bench --kepler [N...]        (default 100000 1000000)
+//   nbody_bench --cull [N...]          (default 100000 1000000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BarnesHut.h"
+#include "FrustumCuller.h"
+#include "GravityKernel.h"
+#include "JobSystem.h"
+#include "KeplerOrbit.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+struct Bodies
+{
+    std::vector<double> x, y, z, mass;
+};
+
+static Bodies makeCluster(size_t n)
+{
+    // fixed seed: every run and every kernel sees the same bodies
+    std::mt19937_64 rng(12345);
+    std::normal_distribution<double> position(0.0, 30.0);
+    std::uniform_real_distribution<double> mass(1e-7, 1e-5);
+
+    Bodies bodies;
+    for (size_t i = 0; i < n; i++)
+    {
+        bodies.x.push_back(position(rng));
+        bodies.y.push_back(position(rng) * 0.1);
+        bodies.z.push_back(position(rng));
+        bodies.mass.push_back(mass(rng));
+    }
+    return bodies;
+}
+
+static double relativeError(double ax, double ay, double az, double refX, double refY, double refZ)
+{
+    double ref = std::sqrt(refX * refX + refY * refY + refZ * refZ);
+    double diff = std::sqrt((ax - refX) * (ax - refX) + (ay - refY) * (ay - refY) + (az - refZ) * (az - refZ));
+    return ref > 0.0 ? diff / ref : 0.0;
+}
+
+static void reportBarnesHut(size_t n, double eps2)
+{
+    Bodies bodies = makeCluster(n);
+
+    // the reference is direct summation, which is only affordable for a sample of the bodies
+    const size_t samples = std::min<size_t>(n, 1000);
+    std::vector<size_t> sample(samples);
+    std::vector<double> refX(samples), refY(samples), refZ(samples);
+    for (size_t s = 0; s < samples; s++)
+    {
+        size_t i = s * n / samples;
+        sample[s] = i;
+        double accX = 0.0, accY = 0.0, accZ = 0.0;
+        for (size_t j = 0; j < n; j++)
+        {
+            double dx = bodies.x[j] - bodies.x[i];
+            double dy = bodies.y[j] - bodies.y[i];
+            double dz = bodies.z[j] - bodies.z[i];
+            double invR = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz + eps2);
+            double f = bodies.mass[j] * invR * invR * invR;
+            accX += f * dx;
+            accY += f * dy;
+            accZ += f * dz;
+        }
+        refX[s] = accX;
+        refY[s] = accY;
+        refZ[s] = accZ;
+    }
+
+    BarnesHutTree tree;
+    auto start = std::chrono::steady_clock::now();
+    tree.build(n, bodies.x.data(), bodies.y.data(), bodies.z.data(), bodies.mass.data());
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "N=" << n << "  " << tree.nodes().size() << " nodes, build "
+              << std::fixed << std::setprecision(3) << buildMs << " ms" << std::defaultfloat << std::endl;
+
+    std::vector<double> ax(n), ay(n), az(n);
+    for (double theta : { 0.2, 0.3, 0.5, 0.7, 1.0 })
+    {
+        start = std::chrono::steady_clock::now();
+        tree.accelerations(theta, eps2, ax.data(), ay.data(), az.data());
+        double walkMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<double> errors(samples);
+        for (size_t s = 0; s < samples; s++)
+        {
+            size_t i = sample[s];
+            errors[s] = relativeError(ax[i], ay[i], az[i], refX[s], refY[s], refZ[s]);
+        }
+        std::sort(errors.begin(), errors.end());
+
+        // the walk scales with threads, so this is what to extrapolate to another machine from
+        double perThread = (double)n / (walkMs * 1e-3) / (double)(JobSystem::global().workerCount() + 1);
+        std::cout << "  theta " << std::fixed << std::setprecision(1) << theta
+                  << "  walk " << std::setprecision(3) << std::setw(10) << walkMs << " ms"
+                  << std::scientific << std::setprecision(2) << "  " << perThread << " bodies/s per thread"
+                  << std::scientific << std::setprecision(2)
+                  << "  median rel error " << errors[samples / 2]
+                  << "  p99 " << errors[std::min(samples - 1, samples * 99 / 100)]
+                  << std::defaultfloat << std::endl;
+    }
+}
+
+static void reportKepler(size_t n)
+{
+    // mostly near-circular, with a few very eccentric orbits where Newton needs the most steps
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double gm = 15.0;
+
+    std::vector<KeplerOrbit> orbits(n);
+    KeplerOrbitSet set;
+    for (KeplerOrbit& orbit : orbits)
+    {
+        orbit.semiMajorAxis = 20.0 + 10.0 * unit(rng);
+        orbit.eccentricity = unit(rng) < 0.01 ? 0.99 * unit(rng) : 0.3 * unit(rng);
+        orbit.inclination = 0.5 * unit(rng);
+        orbit.ascendingNode = 6.283 * unit(rng);
+        orbit.argumentOfPeriapsis = 6.283 * unit(rng);
+        orbit.meanAnomaly = 6.283 * unit(rng);
+        set.add(orbit, gm);
+    }
+
+    std::vector<double> x(n), y(n), z(n);
+    for (double time : { 0.0, 100.0, 1e5 })
+    {
+        auto start = std::chrono::steady_clock::now();
+        set.positions(time, x.data(), y.data(), z.data());
+        double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        double maxError = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++)
+        {
+            glm::dvec3 position = orbits[i].position(gm, time);
+            maxError = std::max(maxError, glm::length(position - glm::dvec3(x[i], y[i], z[i])) / orbits[i].semiMajorAxis);
+        }
+        double singleMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "N=" << n << "  t=" << time << std::fixed << std::setprecision(3)
+                  << "  batched " << std::setw(9) << batchMs << " ms  one at a time " << std::setw(9) << singleMs << " ms"
+                  << std::scientific << std::setprecision(2) << "  max rel difference " << maxError
+                  << std::defaultfloat << std::endl;
+    }
+}
+static void reportCull(size_t n)
+{
+    // a belt-like ring of spheres seen from inside it, looking along it, so most fall outside
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> x(n), y(n), z(n), radius(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        float angle = 6.283f * unit(rng);
+        float distance = 15.0f + 15.0f * unit(rng);
+        x[i] = distance * std::cos(angle);
+        y[i] = 2.0f * unit(rng) - 1.0f;
+        z[i] = distance * std::sin(angle);
+        radius[i] = 0.01f + 0.2f * unit(rng);
+    }
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 4.0f / 3.0f, 0.1f, 1000.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(22.0f, 1.5f, 0.0f), glm::vec3(22.0f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::fromMatrix(projection * view);
+
+    std::vector<uint32_t> reference(n), visible(n);
+    size_t referenceCount = frustumCullScalar(frustum, n, x.data(), y.data(), z.data(), radius.data(), reference.data());
+
+    std::vector<FrustumCullFn> kernels = { frustumCullScalar };
+    if (frustumCullKernel(detectSimdLevel()) != frustumCullScalar)
+        kernels.push_back(frustumCullKernel(detectSimdLevel()));
+    for (FrustumCullFn kernel : kernels)
+    {
+        int runs = 0;
+        size_t count = 0;
+        double elapsedMs = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        while (elapsedMs < 250.0)
+        {
+            count = kernel(frustum, n, x.data(), y.data(), z.data(), radius.data(), visible.data());
+            runs++;
+            elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        bool same = count == referenceCount && std::equal(visible.begin(), visible.begin() + count, reference.begin());
+
+        std::cout << "N=" << std::setw(8) << n << "  " << std::setw(6) << (kernel == frustumCullScalar ? "scalar" : "AVX")
+                  << std::fixed << std::setprecision(3) << std::setw(10) << elapsedMs / runs << " ms"
+                  << std::setprecision(2) << std::setw(8) << elapsedMs / runs * 1e6 / n << " ns/sphere  "
+                  << count << " visible" << (same ? "" : "  MISMATCH with scalar") << std::defaultfloat << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool barnesHut = false, kepler = false, cull = false;
+    std::vector<size_t> counts;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string(argv[i]) == "--barnes-hut")
+            barnesHut = true;
+        else if (std::string(argv[i]) == "--kepler")
+            kepler = true;
+        else if (std::string(argv[i]) == "--cull")
+            cull = true;
+        else
+            counts.push_back((size_t)std::strtoul(argv[i], nullptr, 10));
+    }
+
+    const double eps2 = 1e-6;
+    if (barnesHut || kepler || cull)
+    {
+        if (counts.empty())
+            counts = { 100000, 1000000 };
+        for (size_t n : counts)
+        {
+            if (barnesHut)
+                reportBarnesHut(n, eps2);
+            else if (kepler)
+                reportKepler(n);
+            else
+                reportCull(n);
+        }
+        return 0;
+    }
+
+    if (counts.empty())
+        counts = { 1000, 2000, 5000 };
+    SimdLevel best = detectSimdLevel();
+    std::cout << "widest supported: " << simdLevelName(best) << std::endl;
+
+    for (size_t n : counts)
+    {
+        Bodies bodies = makeCluster(n);
+        std::vector<double> refX(n), refY(n), refZ(n);
+        gravityKernelScalar(0, n, n, bodies.x.data(), bodies.y.data(), bodies.z.data(), bodies.mass.data(), eps2,
+            refX.data(), refY.data(), refZ.data());
+
+        for (int level = (int)SimdLevel::Scalar; level <= (int)best; level++)
+        {
+            GravityKernelFn kernel = gravityKernel((SimdLevel)level);
+            std::vector<double> ax(n), ay(n), az(n);
+
+            // repeat until at least a quarter second has been measured
+            int runs = 0;
+            double elapsedMs = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            while (elapsedMs < 250.0)
+            {
+                kernel(0, n, n, bodies.x.data(), bodies.y.data(), bodies.z.data(), bodies.mass.data(), eps2, ax.data(), ay.data(), az.data());
+                runs++;
+                elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            double maxError = 0.0;
+            for (size_t i = 0; i < n; i++)
+                maxError = std::max(maxError, relativeError(ax[i], ay[i], az[i], refX[i], refY[i], refZ[i]));
+
+            double msPerRun = elapsedMs / runs;
+            double interactions = (double)n * (double)n / (msPerRun / 1000.0);
+            std::cout << "N=" << std::setw(6) << n << "  " << std::setw(8) << simdLevelName((SimdLevel)level)
+                      << std::fixed << std::setprecision(3) << std::setw(10) << msPerRun << " ms"
+                      << std::scientific << std::setprecision(3) << std::setw(12) << interactions << " interactions/s"
+                      << "  max rel error " << std::setprecision(2) << maxError
+                      << std::defaultfloat << std::endl;
+        }
+    }
+    return 0;
+}
@@ -5,10 +5,24 @@
 #include <glm/glm.hpp>
 #include <glm/gtx/matrix_operation.hpp>
 
+#include "AssetPack.h"
+#include "FrameUBO.h"
+#include "Trace.h"
+
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <memory>
+#include <vector>
+#include <cstring>
+
+// pre-resolved uniform: GL location plus its slot in the program's uniform table
+struct UniformHandle
+{
+    int location = -1;
+    int slot = -1;
+};
 
 class Shader
 {
@@ -18,46 +32,25 @@ public:
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
+        TraceScope trace("compile shader", vertexPath);
+        // 1. retrieve the vertex/fragment source code, straight out of the asset pack when it has them
         std::string vertexCode;
         std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
-        try 
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode   = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char * fShaderCode = fragmentCode.c_str();
+        const char* vShaderCode;
+        const char* fShaderCode;
+        GLint vShaderLength, fShaderLength;
+        readSource(vertexPath, vertexCode, vShaderCode, vShaderLength);
+        readSource(fragmentPath, fragmentCode, fShaderCode, fShaderLength);
         // 2. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
+        glShaderSource(vertex, 1, &vShaderCode, &vShaderLength);
         glCompileShader(vertex);
         checkCompileErrors(vertex, "VERTEX");
         // fragment Shader
         fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
+        glShaderSource(fragment, 1, &fShaderCode, &fShaderLength);
         glCompileShader(fragment);
         checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
@@ -66,6 +59,8 @@ public:
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        reflectUniforms();
+        FrameUBO::bindProgram(ID);
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -76,34 +71,187 @@ public:
     { 
         glUseProgram(ID); 
     }
+    // look up a uniform once, then pass the handle to set() every frame
+    // ------------------------------------------------------------------------
+    UniformHandle uniform(const char* name) const
+    {
+        UniformHandle handle;
+        const std::vector<UniformSlot>& slots = m_Uniforms->slots;
+        size_t mask = slots.size() - 1;
+        for (size_t i = hashName(name) & mask; slots[i].location != -1; i = (i + 1) & mask)
+        {
+            if (slots[i].name == name)
+            {
+                handle.location = slots[i].location;
+                handle.slot = (int)i;
+                break;
+            }
+        }
+        return handle;
+    }
+    UniformHandle uniform(const std::string &name) const
+    {
+        return uniform(name.c_str());
+    }
+    // typed setters; values equal to the last upload to this program are skipped
+    // ------------------------------------------------------------------------
+    void set(UniformHandle handle, int value)
+    {
+        if (changed(handle, &value, sizeof(value)))
+            glUniform1i(handle.location, value);
+    }
+    void set(UniformHandle handle, float value)
+    {
+        if (changed(handle, &value, sizeof(value)))
+            glUniform1f(handle.location, value);
+    }
+    void set(UniformHandle handle, const glm::vec2& vector)
+    {
+        if (changed(handle, &vector[0], sizeof(vector)))
+            glUniform2f(handle.location, vector.x, vector.y);
+    }
+    void set(UniformHandle handle, const glm::vec3& vector)
+    {
+        if (changed(handle, &vector[0], sizeof(vector)))
+            glUniform3f(handle.location, vector.x, vector.y, vector.z);
+    }
+    void set(UniformHandle handle, const glm::mat4& matrix)
+    {
+        if (changed(handle, &matrix[0][0], sizeof(matrix)))
+            glUniformMatrix4fv(handle.location, 1, GL_FALSE, &matrix[0][0]);
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
-    void setBool(const std::string &name, bool value) const
+    void setBool(const std::string &name, bool value)
     {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+        set(uniform(name), (int)value); 
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string &name, int value) const
+    void setInt(const std::string &name, int value)
     { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+        set(uniform(name), value); 
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string &name, float value) const
+    void setFloat(const std::string &name, float value)
     { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+        set(uniform(name), value); 
     }
     // ------------------------------------------------------------------------
     void SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &matrix[0][0]);
+        set(uniform(name), matrix);
     }
     // ------------------------------------------------------------------------
     void SetUniformVec3f(const std::string& name, const glm::vec3& vector)
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), vector.x, vector.y, vector.z);
+        set(uniform(name), vector);
     }
 
 private:
+    // one open-addressed slot per active uniform, with a shadow of the last value uploaded
+    struct UniformSlot
+    {
+        std::string name;
+        int location = -1;
+        bool valid = false;
+        float value[16];
+    };
+    struct UniformTable
+    {
+        std::vector<UniformSlot> slots;
+    };
+    // shared so that copies of a Shader (same program) agree on what is uploaded
+    std::shared_ptr<UniformTable> m_Uniforms;
+
+    static size_t hashName(const char* name)
+    {
+        // FNV-1a
+        unsigned int hash = 2166136261u;
+        for (; *name; name++)
+            hash = (hash ^ (unsigned char)*name) * 16777619u;
+        return hash;
+    }
+    // returns false when the value matches the shadow, so the glUniform* call can be skipped
+    bool changed(UniformHandle handle, const void* value, size_t bytes)
+    {
+        if (handle.slot < 0)
+            return false;
+        UniformSlot& slot = m_Uniforms->slots[handle.slot];
+        if (slot.valid && std::memcmp(slot.value, value, bytes) == 0)
+            return false;
+        std::memcpy(slot.value, value, bytes);
+        slot.valid = true;
+        return true;
+    }
+    // read every active uniform once after linking instead of asking the driver by name per call
+    // ------------------------------------------------------------------------
+    void reflectUniforms()
+    {
+        m_Uniforms = std::make_shared<UniformTable>();
+
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+        // power of two with at least half the slots free keeps probe chains short
+        size_t capacity = 8;
+        while (capacity < (size_t)count * 2)
+            capacity *= 2;
+        m_Uniforms->slots.resize(capacity);
+
+        std::vector<char> name(maxLength + 1);
+        for (int i = 0; i < count; i++)
+        {
+            int size;
+            GLenum type;
+            glGetActiveUniform(ID, i, (GLsizei)name.size(), NULL, &size, &type, name.data());
+            int location = glGetUniformLocation(ID, name.data());
+            if (location == -1)
+                continue; // uniform block members have no location
+
+            // arrays are reported as "name[0]"; register them under the plain name
+            std::string key = name.data();
+            if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0)
+                key.resize(key.size() - 3);
+
+            size_t mask = capacity - 1;
+            size_t slot = hashName(key.c_str()) & mask;
+            while (m_Uniforms->slots[slot].location != -1)
+                slot = (slot + 1) & mask;
+            m_Uniforms->slots[slot].name = key;
+            m_Uniforms->slots[slot].location = location;
+        }
+    }
+    // point code/length at the mapped bytes of a packed shader, or read the loose file into storage
+    // ------------------------------------------------------------------------
+    static void readSource(const char* path, std::string& storage, const char*& code, GLint& length)
+    {
+        const AssetPack& pack = AssetPack::mounted();
+        if (const PackEntry* entry = pack.lookup(path))
+        {
+            code = (const char*)pack.data(*entry);
+            length = (GLint)entry->size;
+            return;
+        }
+
+        std::ifstream shaderFile;
+        // ensure ifstream objects can throw exceptions:
+        shaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            shaderFile.open(path);
+            std::stringstream shaderStream;
+            shaderStream << shaderFile.rdbuf();
+            shaderFile.close();
+            storage = shaderStream.str();
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        }
+        code = storage.c_str();
+        length = (GLint)storage.size();
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(unsigned int shader, std::string type)
@@ -0,0 +1,149 @@
+// texbake: offline texture compiler.
+// Converts images into BC1 (opaque) or BC3 (with alpha) .dds files carrying a full
+// mip chain, written next to each input with the extension replaced. AssetLoader
+// picks those up instead of decoding the originals at startup.
+//
+//   texbake [--size WxH] image...
+//
+// --size resamples level 0 first, e.g. to the planet texture-array layer size.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+#include "STB/stb_image_resize2.h"
+
+// stb_dxt uses memcpy without including <cstring> itself
+#define STB_DXT_IMPLEMENTATION
+#include "STB/stb_dxt.h"
+
+#include "DDSFile.h"
+
+// compress one RGBA8 level, clamping the edge blocks of sizes that are not multiples of 4
+static void compressLevel(const unsigned char* rgba, int width, int height, bool alpha, unsigned char* out)
+{
+    size_t blockBytes = alpha ? 16 : 8;
+    unsigned char block[4 * 4 * 4];
+
+    for (int by = 0; by < height; by += 4)
+    {
+        for (int bx = 0; bx < width; bx += 4)
+        {
+            for (int y = 0; y < 4; y++)
+            {
+                for (int x = 0; x < 4; x++)
+                {
+                    int sx = std::min(bx + x, width - 1);
+                    int sy = std::min(by + y, height - 1);
+                    std::memcpy(&block[(y * 4 + x) * 4], &rgba[((size_t)sy * width + sx) * 4], 4);
+                }
+            }
+            stb_compress_dxt_block(out, block, alpha ? 1 : 0, STB_DXT_HIGHQUAL);
+            out += blockBytes;
+        }
+    }
+}
+
+static bool bake(const std::string& input, int targetWidth, int targetHeight)
+{
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(input.c_str(), &width, &height, &nrChannels, 4);
+    if (!data)
+    {
+        std::cout << "texbake: failed to load " << input << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> level(data, data + (size_t)width * height * 4);
+    stbi_image_free(data);
+
+    // opaque images still go through as RGBA8, with the constant alpha left out of the filtering
+    bool alpha = nrChannels == 2 || nrChannels == 4;
+
+    if (targetWidth && (width != targetWidth || height != targetHeight))
+    {
+        std::vector<unsigned char> resized((size_t)targetWidth * targetHeight * 4);
+        stbir_resize_uint8_srgb(level.data(), width, height, 0, resized.data(), targetWidth, targetHeight, 0, alpha ? STBIR_RGBA : STBIR_4CHANNEL);
+        level.swap(resized);
+        width = targetWidth;
+        height = targetHeight;
+    }
+
+    DDSInfo info;
+    info.format = alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    info.width = width;
+    info.height = height;
+    info.levels = 1;
+    while ((width >> info.levels) > 0 || (height >> info.levels) > 0)
+        info.levels++;
+
+    std::vector<unsigned char> payload(ddsPayloadSize(info));
+
+    // each level is filtered down from the previous one in linear light
+    int levelWidth = width, levelHeight = height;
+    for (int i = 0; i < info.levels; i++)
+    {
+        compressLevel(level.data(), levelWidth, levelHeight, alpha, payload.data() + ddsLevelOffset(info, i));
+
+        if (i + 1 < info.levels)
+        {
+            int nextWidth = std::max(1, levelWidth / 2);
+            int nextHeight = std::max(1, levelHeight / 2);
+            std::vector<unsigned char> next((size_t)nextWidth * nextHeight * 4);
+            stbir_resize_uint8_srgb(level.data(), levelWidth, levelHeight, 0, next.data(), nextWidth, nextHeight, 0, alpha ? STBIR_RGBA : STBIR_4CHANNEL);
+            level.swap(next);
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+        }
+    }
+
+    std::string output = bakedPath(input);
+    if (!writeDDS(output, info, payload.data()))
+    {
+        std::cout << "texbake: failed to write " << output << std::endl;
+        return false;
+    }
+
+    std::cout << input << " -> " << output << ": " << width << "x" << height << " "
+              << (alpha ? "BC3" : "BC1") << ", " << info.levels << " mips, "
+              << (size_t)width * height * nrChannels << " -> " << payload.size() << " bytes" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int targetWidth = 0, targetHeight = 0;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &targetWidth, &targetHeight) != 2)
+            {
+                std::cout << "texbake: --size expects WxH" << std::endl;
+                return 1;
+            }
+        }
+        else
+        {
+            inputs.push_back(argv[i]);
+        }
+    }
+
+    if (inputs.empty())
+    {
+        std::cout << "usage: texbake [--size WxH] image..." << std::endl;
+        return 1;
+    }
+
+    int failed = 0;
+    for (const std::string& input : inputs)
+        if (!bake(input, targetWidth, targetHeight))
+            failed++;
+    return failed ? 1 : 0;
+}